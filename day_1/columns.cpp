@@ -0,0 +1,273 @@
+#include "columns.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <span>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+template <typename T>
+T load_le(const char* p)
+{
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    return value;
+}
+
+template <typename T>
+void store_le(char* p, T value)
+{
+    if constexpr (std::endian::native == std::endian::big) {
+        value = std::byteswap(value);
+    }
+    std::memcpy(p, &value, sizeof(T));
+}
+
+bool has_magic(std::span<const char> bytes)
+{
+    return bytes.size() >= columns_magic.size()
+        && std::equal(columns_magic.begin(), columns_magic.end(), bytes.begin());
+}
+
+// Validates the header and returns the number of rows
+std::size_t binary_row_count(std::span<const char> bytes)
+{
+    if (bytes.size() < columns_header_size) {
+        throw std::invalid_argument("columns: Truncated header");
+    }
+    if (load_le<std::uint32_t>(bytes.data() + 8) != columns_version) {
+        throw std::invalid_argument("columns: Unsupported format version");
+    }
+
+    const auto count = load_le<std::uint64_t>(bytes.data() + 16);
+    const std::size_t payload = bytes.size() - columns_header_size;
+    if (count > payload / (2 * sizeof(std::int64_t))
+        || payload != count * 2 * sizeof(std::int64_t)) {
+        throw std::invalid_argument("columns: Payload size does not match the row count");
+    }
+    return static_cast<std::size_t>(count);
+}
+
+Columns decode_binary_columns(std::span<const char> bytes)
+{
+    const std::size_t count = binary_row_count(bytes);
+    const char* left = bytes.data() + columns_header_size;
+    const char* right = left + count * sizeof(std::int64_t);
+
+    std::vector<std::int64_t> v1(count);
+    std::vector<std::int64_t> v2(count);
+    for (std::size_t i { 0 }; i < count; ++i) {
+        v1[i] = load_le<std::int64_t>(left + i * sizeof(std::int64_t));
+        v2[i] = load_le<std::int64_t>(right + i * sizeof(std::int64_t));
+    }
+    return Columns { std::move(v1), std::move(v2) };
+}
+
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+Columns::Columns(std::vector<std::int64_t> left, std::vector<std::int64_t> right)
+    : left_values { std::move(left) }
+    , right_values { std::move(right) }
+    , left_span { left_values }
+    , right_span { right_values }
+{
+    if (left_values.size() != right_values.size()) {
+        throw std::invalid_argument("columns: Two columns must have the same length");
+    }
+}
+
+Columns::Columns(void* mapping_, std::size_t mapping_size_, std::size_t count)
+    : mapping { mapping_ }
+    , mapping_size { mapping_size_ }
+{
+    auto* first
+        = reinterpret_cast<std::int64_t*>(static_cast<char*>(mapping) + columns_header_size);
+    left_span = std::span<std::int64_t> { first, count };
+    right_span = std::span<std::int64_t> { first + count, count };
+}
+
+Columns::Columns(Columns&& other) noexcept
+    : left_values { std::move(other.left_values) }
+    , right_values { std::move(other.right_values) }
+    , mapping { std::exchange(other.mapping, nullptr) }
+    , mapping_size { std::exchange(other.mapping_size, 0) }
+{
+    // Moving a vector keeps its buffer, so the spans remain valid either way
+    left_span = std::exchange(other.left_span, {});
+    right_span = std::exchange(other.right_span, {});
+}
+
+Columns& Columns::operator=(Columns&& other) noexcept
+{
+    if (this != &other) {
+        release();
+        left_values = std::move(other.left_values);
+        right_values = std::move(other.right_values);
+        mapping = std::exchange(other.mapping, nullptr);
+        mapping_size = std::exchange(other.mapping_size, 0);
+        left_span = std::exchange(other.left_span, {});
+        right_span = std::exchange(other.right_span, {});
+    }
+    return *this;
+}
+
+Columns::~Columns()
+{
+    release();
+}
+
+void Columns::release()
+{
+    if (mapping != nullptr) {
+        ::munmap(mapping, mapping_size);
+        mapping = nullptr;
+        mapping_size = 0;
+    }
+}
+
+Columns Columns::read(int fd)
+{
+    struct stat st { };
+    if (::fstat(fd, &st) != 0) {
+        throw_errno("columns: fstat");
+    }
+
+    if (S_ISREG(st.st_mode)) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        if (size == 0) {
+            return Columns { {}, {} };
+        }
+
+        // Private and writable: sorting the spans dirties only our own copy
+        void* addr = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED) {
+            throw_errno("columns: mmap");
+        }
+        Columns mapped { addr, size, 0 };
+        const std::span<const char> bytes { static_cast<const char*>(addr), size };
+
+        if (!has_magic(bytes)) {
+            return parse_text_columns(bytes);
+        }
+        if constexpr (std::endian::native != std::endian::little) {
+            return decode_binary_columns(bytes);
+        }
+        const std::size_t count = binary_row_count(bytes);
+        ::madvise(addr, size, MADV_WILLNEED);
+        return Columns { std::exchange(mapped.mapping, nullptr), size, count };
+    }
+
+    std::vector<char> buffer;
+    std::array<char, 1 << 16> chunk;
+    while (true) {
+        const ::ssize_t n = ::read(fd, chunk.data(), chunk.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("columns: read");
+        }
+        if (n == 0) {
+            break;
+        }
+        buffer.insert(buffer.end(), chunk.begin(), chunk.begin() + n);
+    }
+
+    if (has_magic(buffer)) {
+        return decode_binary_columns(buffer);
+    }
+    return parse_text_columns(buffer);
+}
+
+Columns parse_text_columns(std::span<const char> text)
+{
+    std::vector<std::int64_t> v1;
+    std::vector<std::int64_t> v2;
+
+    const char* p = text.data();
+    const char* const end = text.data() + text.size();
+    auto next_number = [&p, end](std::int64_t& value) {
+        while (p != end && std::isspace(static_cast<unsigned char>(*p))) {
+            ++p;
+        }
+        if (p == end) {
+            return false;
+        }
+        const auto [ptr, ec] = std::from_chars(p, end, value);
+        if (ec != std::errc {}) {
+            throw std::invalid_argument("columns: Not a valid location ID");
+        }
+        p = ptr;
+        return true;
+    };
+
+    std::int64_t pos1;
+    std::int64_t pos2;
+    while (next_number(pos1)) {
+        if (!next_number(pos2)) {
+            throw std::invalid_argument("columns: Unpaired location ID");
+        }
+        v1.push_back(pos1);
+        v2.push_back(pos2);
+    }
+
+    return Columns { std::move(v1), std::move(v2) };
+}
+
+void write_columns(
+    std::FILE* out, std::span<const std::int64_t> left, std::span<const std::int64_t> right)
+{
+    if (left.size() != right.size()) {
+        throw std::invalid_argument("columns: Two columns must have the same length");
+    }
+
+    std::array<char, columns_header_size> header {};
+    std::copy(columns_magic.begin(), columns_magic.end(), header.begin());
+    store_le<std::uint32_t>(header.data() + 8, columns_version);
+    store_le<std::uint64_t>(header.data() + 16, left.size());
+    if (std::fwrite(header.data(), 1, header.size(), out) != header.size()) {
+        throw_errno("columns: write");
+    }
+
+    std::array<char, 8 * 4096> buffer;
+    for (const auto column : { left, right }) {
+        std::size_t used { 0 };
+        for (const auto x : column) {
+            store_le<std::int64_t>(buffer.data() + used, x);
+            used += sizeof(std::int64_t);
+            if (used == buffer.size()) {
+                if (std::fwrite(buffer.data(), 1, used, out) != used) {
+                    throw_errno("columns: write");
+                }
+                used = 0;
+            }
+        }
+        if (used != 0 && std::fwrite(buffer.data(), 1, used, out) != used) {
+            throw_errno("columns: write");
+        }
+    }
+}
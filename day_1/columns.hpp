@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <vector>
+
+// Binary columnar layout of the location lists:
+//   bytes  0..7  : magic "AOC1COLS"
+//   bytes  8..11 : format version (little-endian uint32)
+//   bytes 12..15 : reserved, zero
+//   bytes 16..23 : number of rows n (little-endian uint64)
+//   then n little-endian int64 values of the left column,
+//   then n little-endian int64 values of the right column.
+// The header is 24 bytes, so both columns stay 8-byte aligned in a mapping.
+inline constexpr std::array<char, 8> columns_magic { 'A', 'O', 'C', '1', 'C', 'O', 'L', 'S' };
+inline constexpr std::uint32_t columns_version { 1 };
+inline constexpr std::size_t columns_header_size { 24 };
+
+// The two location lists, either owned or backed by a private file mapping.
+// The spans are writable either way: distance() sorts in place, and a private
+// mapping turns that into copy-on-write pages instead of touching the file.
+class Columns {
+public:
+    Columns(std::vector<std::int64_t> left, std::vector<std::int64_t> right);
+    Columns(Columns&& other) noexcept;
+    Columns& operator=(Columns&& other) noexcept;
+    Columns(const Columns&) = delete;
+    Columns& operator=(const Columns&) = delete;
+    ~Columns();
+
+    std::span<std::int64_t> left() { return left_span; }
+    std::span<std::int64_t> right() { return right_span; }
+    std::size_t size() const { return left_span.size(); }
+
+    // Reads either format from an open file descriptor. Regular files are
+    // mapped; binary ones are used in place, text ones are parsed from the
+    // mapping. Anything else (pipes, terminals) is read into memory first.
+    static Columns read(int fd);
+
+private:
+    Columns(void* mapping, std::size_t mapping_size, std::size_t count);
+    void release();
+
+    std::vector<std::int64_t> left_values;
+    std::vector<std::int64_t> right_values;
+    void* mapping { nullptr };
+    std::size_t mapping_size { 0 };
+    std::span<std::int64_t> left_span;
+    std::span<std::int64_t> right_span;
+};
+
+// Parses whitespace separated pairs "<left> <right>" as in the puzzle input.
+Columns parse_text_columns(std::span<const char> text);
+
+// Writes both columns in the binary format described above.
+void write_columns(
+    std::FILE* out, std::span<const std::int64_t> left, std::span<const std::int64_t> right);
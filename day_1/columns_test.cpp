@@ -0,0 +1,36 @@
+#include "columns.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string_view>
+#include <vector>
+
+TEST(Columns, ParseText)
+{
+    constexpr std::string_view text { "3   4\n4   3\n2   5\n1   3\n3   9\n3   3\n" };
+    auto columns = parse_text_columns(text);
+
+    ASSERT_EQ(columns.size(), 6U);
+    ASSERT_EQ(std::vector<std::int64_t>(columns.left().begin(), columns.left().end()),
+        (std::vector<std::int64_t> { 3, 4, 2, 1, 3, 3 }));
+    ASSERT_EQ(std::vector<std::int64_t>(columns.right().begin(), columns.right().end()),
+        (std::vector<std::int64_t> { 4, 3, 5, 3, 9, 3 }));
+}
+
+TEST(Columns, BinaryRoundTrip)
+{
+    const auto v1 = std::vector<std::int64_t> { 3, 4, 2, -1, 3, 1LL << 40 };
+    const auto v2 = std::vector<std::int64_t> { 4, 3, 5, 3, 9, -(1LL << 40) };
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_TRUE(file != nullptr);
+    write_columns(file, v1, v2);
+    std::fflush(file);
+
+    auto columns = Columns::read(fileno(file));
+    std::fclose(file);
+
+    ASSERT_EQ(std::vector<std::int64_t>(columns.left().begin(), columns.left().end()), v1);
+    ASSERT_EQ(std::vector<std::int64_t>(columns.right().begin(), columns.right().end()), v2);
+}
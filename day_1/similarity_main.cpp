@@ -1,22 +1,38 @@
+#include "columns.hpp"
 #include "similarity.hpp"
 
+#include <cstdlib>
+#include <exception>
 #include <iostream>
 #include <print>
-#include <vector>
 
-int main()
+#include <fcntl.h>
+#include <unistd.h>
+
+int main(int argc, char* argv[])
 {
-    std::vector<std::int64_t> v1;
-    std::vector<std::int64_t> v2;
+    if (argc > 2) {
+        std::println(std::cerr, "Usage: {} [input file, text or binary columns]", argv[0]);
+        return EXIT_FAILURE;
+    }
 
-    std::int64_t pos1;
-    std::int64_t pos2;
-    while ((std::cin >> pos1 >> pos2)) {
-        v1.push_back(pos1);
-        v2.push_back(pos2);
+    // Without a file argument, read either format from stdin
+    const int fd = (argc == 2) ? ::open(argv[1], O_RDONLY) : STDIN_FILENO;
+    if (fd < 0) {
+        std::println(std::cerr, "Cannot open {}", argv[1]);
+        return EXIT_FAILURE;
     }
+    try {
+        auto columns = Columns::read(fd);
+        if (fd != STDIN_FILENO) {
+            ::close(fd);
+        }
 
-    std::println("Similarity score: {}", similarity_score(v1, v2));
+        std::println("Similarity score: {}", similarity_score(columns.left(), columns.right()));
+    } catch (const std::exception& e) {
+        std::println(std::cerr, "{}", e.what());
+        return EXIT_FAILURE;
+    }
 
     return 0;
 }
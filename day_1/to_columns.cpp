@@ -0,0 +1,40 @@
+#include "columns.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <print>
+
+#include <unistd.h>
+
+// Converts the text puzzle input on stdin into the binary columnar format
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        std::println(std::cerr, "Usage: {} <output file> < input", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        auto columns = Columns::read(STDIN_FILENO);
+
+        std::FILE* out = std::fopen(argv[1], "wb");
+        if (out == nullptr) {
+            std::println(std::cerr, "Cannot open {}", argv[1]);
+            return EXIT_FAILURE;
+        }
+        write_columns(out, columns.left(), columns.right());
+        if (std::fclose(out) != 0) {
+            std::println(std::cerr, "Cannot write {}", argv[1]);
+            return EXIT_FAILURE;
+        }
+
+        std::println("Wrote {} rows", columns.size());
+    } catch (const std::exception& e) {
+        std::println(std::cerr, "{}", e.what());
+        return EXIT_FAILURE;
+    }
+
+    return 0;
+}
@@ -1,85 +1,243 @@
-#include <cmath>
+#include "reports.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
-#include <sstream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
 #include <vector>
 
-bool safe(const std::vector<std::int64_t>& vec)
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+struct Totals {
+    std::optional<std::size_t> tolerance;
+    std::int64_t safe_count { 0 };
+    std::int64_t almost_safe_count { 0 };
+    std::int64_t tolerable_count { 0 };
+
+    void add(const std::vector<std::int64_t>& numbers)
+    {
+        if (safe(numbers)) {
+            ++safe_count;
+            ++almost_safe_count;
+        } else if (almost_safe(numbers)) {
+            ++almost_safe_count;
+        }
+
+        if (tolerance.has_value() && tolerably_safe(numbers, *tolerance)) {
+            ++tolerable_count;
+        }
+    }
+
+    void print() const
+    {
+        std::cout << "Number of safe lines: " << safe_count << std::endl;
+        std::cout << "Number of almost safe lines: " << almost_safe_count << std::endl;
+        if (tolerance.has_value()) {
+            std::cout << "Number of lines safe with up to " << *tolerance
+                      << " removed levels: " << tolerable_count << std::endl;
+        }
+    }
+};
+
+namespace {
+
+// How many of the last bytes read are kept to tell an append from a rewrite
+constexpr std::size_t tail_size { 64 };
+
+bool same_time(const ::timespec& a, const ::timespec& b)
 {
-    if (vec.size() <= 1) {
-        return true;
+    return a.tv_sec == b.tv_sec && a.tv_nsec == b.tv_nsec;
+}
+
+// Whether the bytes just before `offset` are still `tail`
+bool tail_unchanged(int fd, ::off_t offset, const std::string& tail)
+{
+    std::array<char, tail_size> buffer;
+    const auto start = offset - static_cast<::off_t>(tail.size());
+    return ::pread(fd, buffer.data(), tail.size(), start) == static_cast<::ssize_t>(tail.size())
+        && std::string_view { buffer.data(), tail.size() } == tail;
+}
+
+template <typename T>
+std::optional<T> parse_number(std::string_view text)
+{
+    T value {};
+    const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (text.empty() || ec != std::errc {} || ptr != text.data() + text.size()) {
+        return std::nullopt;
     }
+    return value;
+}
+
+} // namespace
 
-    if (vec[0] == vec[1] || std::abs(vec[1] - vec[0]) > 3) {
-        return false;
+// Tails a report log that is being appended to, like `tail -F`. Every byte is
+// read once: complete lines are counted as soon as they arrive, a trailing
+// partial line is kept until its newline shows up, and the running totals are
+// printed after each poll that brought new reports. Empty lines are skipped
+// rather than ending the input. If the log is truncated, what is left of it is
+// new, and it is read again from its start. If it is replaced by a new file
+// (log rotation), the rest of the old file is read and then the new one from
+// its start. If it is rewritten in place, the reports it held may be there
+// again, so its share of the totals is dropped and it is counted from scratch.
+int follow(const char* path, Totals& totals, std::chrono::milliseconds interval)
+{
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open " << path << ": " << std::strerror(errno) << std::endl;
+        return EXIT_FAILURE;
     }
 
-    if (vec[0] < vec[1]) {
-        for (std::size_t i { 2 }; i < vec.size(); ++i) {
-            if ((vec[i - 1] >= vec[i]) || (vec[i] - vec[i - 1] > 3)) {
-                return false;
+    std::string pending;
+    std::string tail;
+    std::array<char, 1 << 16> chunk;
+    ::off_t offset { 0 };
+    ::timespec mtime { };
+    // The totals before anything in the current contents of the file
+    Totals before_file { totals };
+
+    const auto restart = [&](const char* reason) {
+        std::cerr << path << reason << ", following from the start" << std::endl;
+        offset = 0;
+        pending.clear();
+        tail.clear();
+        before_file = totals;
+    };
+
+    while (true) {
+        bool updated { false };
+
+        // A rewrite bumps the modification time; an append does too, but
+        // leaves the bytes already read in place
+        struct stat st { };
+        if (::fstat(fd, &st) == 0 && !same_time(st.st_mtim, mtime)) {
+            if (st.st_size < offset) {
+                restart(" was truncated");
+                ::lseek(fd, 0, SEEK_SET);
+            } else if (!tail_unchanged(fd, offset, tail)) {
+                totals = before_file;
+                updated = true;
+                restart(" was rewritten");
+                ::lseek(fd, 0, SEEK_SET);
             }
         }
-    } else {
-        for (std::size_t i { 2 }; i < vec.size(); ++i) {
-            if ((vec[i - 1] <= vec[i]) || (vec[i - 1] - vec[i] > 3)) {
-                return false;
+
+        while (true) {
+            const ::ssize_t n = ::read(fd, chunk.data(), chunk.size());
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n < 0) {
+                std::cerr << "Cannot read " << path << ": " << std::strerror(errno) << std::endl;
+                ::close(fd);
+                return EXIT_FAILURE;
+            }
+            if (n == 0) {
+                break;
+            }
+            offset += n;
+
+            const std::string_view data { chunk.data(), static_cast<std::size_t>(n) };
+            tail += data.substr(data.size() - std::min(data.size(), tail_size));
+            tail.erase(0, tail.size() - std::min(tail.size(), tail_size));
+
+            pending += data;
+            std::size_t line_start { 0 };
+            for (auto eol = pending.find('\n'); eol != std::string::npos;
+                eol = pending.find('\n', line_start)) {
+                const auto numbers = parse_line(pending.substr(line_start, eol - line_start));
+                if (!numbers.empty()) {
+                    totals.add(numbers);
+                    updated = true;
+                }
+                line_start = eol + 1;
             }
+            pending.erase(0, line_start);
+        }
+        if (::fstat(fd, &st) == 0) {
+            mtime = st.st_mtim;
         }
-    }
 
-    return true;
-}
+        if (updated) {
+            totals.print();
+        }
 
-bool almost_safe(const std::vector<std::int64_t>& vec)
-{
-    for (std::size_t i { 0 }; i < vec.size(); ++i) {
-        auto v_copy = vec;
-        v_copy.erase(v_copy.begin() + static_cast<std::ptrdiff_t>(i));
-        if (safe(v_copy)) {
-            return true;
+        // Once the old file has been read to its end, switch to a new file
+        // that took its name. Until one shows up, keep watching the old one.
+        struct stat named { };
+        if (::stat(path, &named) == 0 && (named.st_ino != st.st_ino || named.st_dev != st.st_dev)) {
+            if (const int new_fd = ::open(path, O_RDONLY); new_fd >= 0) {
+                ::close(fd);
+                fd = new_fd;
+                mtime = { };
+                restart(" was replaced");
+                continue;
+            }
         }
-    }
 
-    return false;
+        std::this_thread::sleep_for(interval);
+    }
 }
 
-std::vector<std::int64_t> parse_line(const std::string& input)
+int main(int argc, char* argv[])
 {
-    std::vector<std::int64_t> result;
-    std::int64_t num;
-    std::stringstream ss { input };
-    while (ss >> num) {
-        result.push_back(num);
+    // --tolerance <k>: also count reports that become safe after removing at most k levels
+    // --follow <file>: keep reading reports appended to the file
+    // --interval <ms>: how often to poll the followed file
+    Totals totals;
+    const char* follow_path { nullptr };
+    std::chrono::milliseconds interval { 500 };
+    bool valid_arguments { argc % 2 == 1 };
+    for (int i { 1 }; valid_arguments && i + 1 < argc; i += 2) {
+        const std::string_view option { argv[i] };
+        if (option == "--tolerance") {
+            totals.tolerance = parse_number<std::size_t>(argv[i + 1]);
+            valid_arguments = totals.tolerance.has_value();
+        } else if (option == "--follow") {
+            follow_path = argv[i + 1];
+        } else if (option == "--interval") {
+            // Zero or less would poll without pause
+            const auto ms = parse_number<std::int64_t>(argv[i + 1]);
+            valid_arguments = ms.has_value() && *ms > 0;
+            interval = std::chrono::milliseconds { ms.value_or(0) };
+        } else {
+            valid_arguments = false;
+        }
+    }
+    if (!valid_arguments) {
+        std::cerr << "Usage: " << argv[0]
+                  << " [--tolerance <max removed levels>] [--follow <file> [--interval <ms>]]"
+                  << std::endl;
+        return EXIT_FAILURE;
     }
 
-    return result;
-}
+    if (follow_path != nullptr) {
+        return follow(follow_path, totals, interval);
+    }
 
-int main()
-{
     std::string input;
-    std::int64_t safe_count { 0 };
-    std::int64_t almost_safe_count { 0 };
-
     while (true) {
         std::getline(std::cin, input);
         const auto numbers = parse_line(input);
         if (numbers.empty()) {
             break;
         }
-
-        if (safe(numbers)) {
-            ++safe_count;
-            ++almost_safe_count;
-        } else if (almost_safe(numbers)) {
-            ++almost_safe_count;
-        }
+        totals.add(numbers);
     }
 
-    std::cout << "Number of safe lines: " << safe_count << std::endl;
-    std::cout << "Number of almost safe lines: " << almost_safe_count << std::endl;
+    totals.print();
     return 0;
 }
@@ -0,0 +1,242 @@
+#include "reports.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+bool good_step(std::int64_t from, std::int64_t to, Direction direction)
+{
+    const std::int64_t diff = (direction == Direction::Increasing) ? (to - from) : (from - to);
+    return diff >= 1 && diff <= 3;
+}
+
+Direction direction_of(std::int64_t first, std::int64_t second)
+{
+    return (first < second) ? Direction::Increasing : Direction::Decreasing;
+}
+
+std::size_t first_violation_scalar(
+    std::span<const std::int64_t> levels, Direction direction, std::size_t start)
+{
+    for (std::size_t i { start + 1 }; i < levels.size(); ++i) {
+        if (!good_step(levels[i - 1], levels[i], direction)) {
+            return i - 1;
+        }
+    }
+    return levels.size();
+}
+
+#if defined(__x86_64__)
+// Checks four adjacent pairs per vector and eight per iteration: the differences
+// are computed lane-wise from two overlapping loads, the range test 1 <= d <= 3
+// becomes two signed compares, and the lanes that fail are turned into a bit mask
+// whose lowest set bit is the first violation.
+// Bit k is set if the pair (p[k], p[k + 1]) is not a good step, for k in 0..3
+__attribute__((target("avx2"))) unsigned bad_steps_avx2(const std::int64_t* p, Direction direction)
+{
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 1));
+    const __m256i diff = (direction == Direction::Increasing) ? _mm256_sub_epi64(b, a)
+                                                              : _mm256_sub_epi64(a, b);
+    const __m256i good = _mm256_and_si256(
+        _mm256_cmpgt_epi64(diff, _mm256_setzero_si256()),
+        _mm256_cmpgt_epi64(_mm256_set1_epi64x(4), diff));
+    return static_cast<unsigned>(~_mm256_movemask_pd(_mm256_castsi256_pd(good))) & 0xFU;
+}
+
+__attribute__((target("avx2"))) std::size_t first_violation_avx2(
+    std::span<const std::int64_t> levels, Direction direction)
+{
+    const std::int64_t* p = levels.data();
+    const std::size_t n = levels.size();
+
+    std::size_t i { 0 };
+    for (; i + 9 <= n; i += 8) {
+        const unsigned mask
+            = bad_steps_avx2(p + i, direction) | (bad_steps_avx2(p + i + 4, direction) << 4);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    for (; i + 5 <= n; i += 4) {
+        const unsigned mask = bad_steps_avx2(p + i, direction);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+
+    return first_violation_scalar(levels, direction, i);
+}
+
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+} // namespace
+
+std::size_t first_violation(std::span<const std::int64_t> levels, Direction direction)
+{
+#if defined(__x86_64__)
+    // Short reports (like the puzzle input) are not worth the vector setup
+    if (has_avx2 && levels.size() >= 16) {
+        return first_violation_avx2(levels, direction);
+    }
+#endif
+    return first_violation_scalar(levels, direction, 0);
+}
+
+bool safe(std::span<const std::int64_t> levels)
+{
+    if (levels.size() <= 1) {
+        return true;
+    }
+
+    return first_violation(levels, direction_of(levels[0], levels[1])) == levels.size();
+}
+
+bool safe_without(std::span<const std::int64_t> levels, std::size_t removed)
+{
+    if (levels.size() <= 2) {
+        return true;
+    }
+
+    const auto before = levels.first(removed);
+    const auto after = levels.subspan(removed + 1);
+
+    // The first two levels left after the removal decide the direction
+    const std::int64_t first = (removed == 0) ? levels[1] : levels[0];
+    const std::int64_t second = (removed <= 1) ? levels[2] : levels[1];
+    const Direction direction = direction_of(first, second);
+
+    if (first_violation(before, direction) != before.size()
+        || first_violation(after, direction) != after.size()) {
+        return false;
+    }
+
+    // The pair that is bridged over the removed level
+    if (!before.empty() && !after.empty()) {
+        return good_step(before.back(), after.front(), direction);
+    }
+    return true;
+}
+
+bool almost_safe(std::span<const std::int64_t> levels)
+{
+    if (levels.size() <= 2) {
+        return true;
+    }
+
+    // Let (i, i + 1) be the first bad pair under the direction of the first pair.
+    // A removal that keeps that direction must break up this pair, so it is i or
+    // i + 1. A removal that flips the direction must change the first pair, so it
+    // is 0 or 1; and removing 1 when i >= 2 joins two good steps, which keeps the
+    // direction. Hence only {0, i, i + 1} need to be tried.
+    const std::size_t i = first_violation(levels, direction_of(levels[0], levels[1]));
+    if (i == levels.size()) {
+        return true;
+    }
+
+    return safe_without(levels, i) || safe_without(levels, i + 1)
+        || (i != 0 && safe_without(levels, 0));
+}
+
+bool tolerably_safe(std::span<const std::int64_t> levels, std::size_t max_removals)
+{
+    const std::size_t n = levels.size();
+    if (n <= max_removals + 1) {
+        return true;
+    }
+
+    // fewest[i]: fewest removals among levels[0..i) such that levels[i] is kept
+    // and ends a valid chain. Only the last kept level matters for extending a
+    // chain, so the minimum is all we need. Predecessors more than max_removals
+    // back would skip too many levels, so each level looks at most k + 1 back.
+    constexpr std::size_t infinity { static_cast<std::size_t>(-1) };
+    std::vector<std::size_t> fewest(n);
+
+    for (const auto direction : { Direction::Increasing, Direction::Decreasing }) {
+        for (std::size_t i { 0 }; i < n; ++i) {
+            fewest[i] = (i <= max_removals) ? i : infinity;
+            const std::size_t lowest = (i > max_removals + 1) ? i - max_removals - 1 : 0;
+            for (std::size_t p { lowest }; p < i; ++p) {
+                if (fewest[p] != infinity && good_step(levels[p], levels[i], direction)) {
+                    fewest[i] = std::min(fewest[i], fewest[p] + (i - p - 1));
+                }
+            }
+
+            // Drop everything after i
+            if (fewest[i] != infinity && fewest[i] + (n - 1 - i) <= max_removals) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+bool safe_reference(const std::vector<std::int64_t>& vec)
+{
+    if (vec.size() <= 1) {
+        return true;
+    }
+
+    if (vec[0] == vec[1] || std::abs(vec[1] - vec[0]) > 3) {
+        return false;
+    }
+
+    if (vec[0] < vec[1]) {
+        for (std::size_t i { 2 }; i < vec.size(); ++i) {
+            if ((vec[i - 1] >= vec[i]) || (vec[i] - vec[i - 1] > 3)) {
+                return false;
+            }
+        }
+    } else {
+        for (std::size_t i { 2 }; i < vec.size(); ++i) {
+            if ((vec[i - 1] <= vec[i]) || (vec[i - 1] - vec[i] > 3)) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool almost_safe_brute_force(const std::vector<std::int64_t>& levels)
+{
+    if (safe_reference(levels)) {
+        return true;
+    }
+
+    for (std::size_t i { 0 }; i < levels.size(); ++i) {
+        auto v_copy = levels;
+        v_copy.erase(v_copy.begin() + static_cast<std::ptrdiff_t>(i));
+        if (safe_reference(v_copy)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<std::int64_t> parse_line(const std::string& input)
+{
+    std::vector<std::int64_t> result;
+    std::int64_t num;
+    std::stringstream ss { input };
+    while (ss >> num) {
+        result.push_back(num);
+    }
+
+    return result;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+enum class Direction {
+    Increasing,
+    Decreasing,
+};
+
+// Returns the index i of the first adjacent pair (i, i + 1) that is not a step of
+// 1 to 3 in the given direction, or levels.size() if there is none.
+// Uses an AVX2 kernel for long reports when the CPU supports it.
+std::size_t first_violation(std::span<const std::int64_t> levels, Direction direction);
+
+// A report is safe if its levels are strictly monotone with steps of 1 to 3.
+bool safe(std::span<const std::int64_t> levels);
+
+// Whether the report is safe after removing the level at index `removed`,
+// checked in place without copying the report.
+bool safe_without(std::span<const std::int64_t> levels, std::size_t removed);
+
+// Whether removing at most one level makes the report safe. Linear time.
+bool almost_safe(std::span<const std::int64_t> levels);
+
+// Whether removing at most `max_removals` levels makes the report safe.
+// Dynamic programming over the last kept level, O(n * max_removals).
+bool tolerably_safe(std::span<const std::int64_t> levels, std::size_t max_removals);
+
+// The original scalar safety check, before first_violation(). Kept as the
+// reference for tests and for almost_safe_brute_force().
+bool safe_reference(const std::vector<std::int64_t>& levels);
+
+// The original quadratic version, which copies the report for every removal.
+// Kept as the reference for tests and benchmarks. Like almost_safe(), it counts
+// a report that is already safe (including an empty one) as almost safe.
+bool almost_safe_brute_force(const std::vector<std::int64_t>& levels);
+
+std::vector<std::int64_t> parse_line(const std::string& input);
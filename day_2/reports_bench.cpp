@@ -0,0 +1,63 @@
+#include "reports.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Long increasing reports with one bad level at a random position, which is the
+// worst case for the brute force version: it only succeeds near that position.
+std::vector<std::vector<std::int64_t>> make_reports(
+    std::size_t count, std::size_t length, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<std::int64_t> step_dist { 1, 3 };
+    std::uniform_int_distribution<std::size_t> pos_dist { 0, length - 1 };
+
+    std::vector<std::vector<std::int64_t>> reports(count);
+    for (auto& report : reports) {
+        report.resize(length);
+        for (std::size_t i { 1 }; i < length; ++i) {
+            report[i] = report[i - 1] + step_dist(rng);
+        }
+        report[pos_dist(rng)] += 100;
+    }
+    return reports;
+}
+
+template <typename F>
+void run(const char* name, const std::vector<std::vector<std::int64_t>>& reports, F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t count { 0 };
+    for (const auto& report : reports) {
+        if (f(report)) {
+            ++count;
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>12}: {} accepted, {:.3f} ms", name, count, elapsed.count());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t count = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 200;
+    const std::size_t length = (argc > 2) ? std::strtoull(argv[2], nullptr, 10) : 5000;
+
+    std::mt19937_64 rng { 2024 };
+    const auto reports = make_reports(count, length, rng);
+    std::println("{} reports of {} levels", count, length);
+
+    run("safe", reports, [](const auto& report) { return safe(report); });
+    run("linear", reports, [](const auto& report) { return almost_safe(report); });
+    run("brute force", reports, [](const auto& report) { return almost_safe_brute_force(report); });
+
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include "reports.hpp"
+
+#include <gtest/gtest.h>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+// A mostly safe report with a few random glitches, so that all of safe, almost
+// safe and unsafe reports show up
+std::vector<std::int64_t> random_report(std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<std::size_t> length_dist { 1, 12 };
+    std::uniform_int_distribution<std::int64_t> step_dist { 1, 3 };
+    std::uniform_int_distribution<std::int64_t> glitch_dist { -5, 5 };
+    std::bernoulli_distribution glitch { 0.15 };
+    std::bernoulli_distribution increasing { 0.5 };
+
+    const std::size_t length = length_dist(rng);
+    const std::int64_t sign = increasing(rng) ? 1 : -1;
+
+    std::vector<std::int64_t> report { 50 };
+    while (report.size() < length) {
+        const std::int64_t step = glitch(rng) ? glitch_dist(rng) : sign * step_dist(rng);
+        report.push_back(report.back() + step);
+    }
+    return report;
+}
+
+// Tries every way of removing at most `max_removals` levels
+bool tolerably_safe_brute_force(const std::vector<std::int64_t>& levels, std::size_t max_removals)
+{
+    const std::size_t n = levels.size();
+    for (std::uint32_t removed { 0 }; removed < (1U << n); ++removed) {
+        if (static_cast<std::size_t>(std::popcount(removed)) > max_removals) {
+            continue;
+        }
+        std::vector<std::int64_t> kept;
+        for (std::size_t i { 0 }; i < n; ++i) {
+            if ((removed & (1U << i)) == 0) {
+                kept.push_back(levels[i]);
+            }
+        }
+        if (safe_reference(kept)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(Reports, SampleTest)
+{
+    const std::vector<std::vector<std::int64_t>> reports {
+        { 7, 6, 4, 2, 1 },
+        { 1, 2, 7, 8, 9 },
+        { 9, 7, 6, 2, 1 },
+        { 1, 3, 2, 4, 5 },
+        { 8, 6, 4, 4, 1 },
+        { 1, 3, 6, 7, 9 },
+    };
+    const std::vector<bool> expected_safe { true, false, false, false, false, true };
+    const std::vector<bool> expected_almost_safe { true, false, false, true, true, true };
+
+    for (std::size_t i { 0 }; i < reports.size(); ++i) {
+        EXPECT_EQ(safe(reports[i]), expected_safe[i]);
+        EXPECT_EQ(almost_safe(reports[i]), expected_almost_safe[i]);
+    }
+}
+
+TEST(Reports, DirectionFlipsAfterRemovingFirstLevel)
+{
+    EXPECT_TRUE(almost_safe(std::vector<std::int64_t> { 5, 4, 6, 7, 8 }));
+    EXPECT_TRUE(almost_safe(std::vector<std::int64_t> { 3, 1, 4, 5, 6 }));
+    EXPECT_TRUE(almost_safe(std::vector<std::int64_t> { 1, 1, 2, 3 }));
+    EXPECT_FALSE(almost_safe(std::vector<std::int64_t> { 5, 4, 6, 7, 7 }));
+}
+
+TEST(Reports, AlmostSafeMatchesBruteForce)
+{
+    std::mt19937_64 rng { 2024 };
+    for (int n { 0 }; n < 200000; ++n) {
+        const auto report = random_report(rng);
+        ASSERT_EQ(safe(report), safe_reference(report));
+        ASSERT_EQ(almost_safe(report), almost_safe_brute_force(report));
+    }
+}
+
+TEST(Reports, EmptyAndSingleLevelReports)
+{
+    const std::vector<std::int64_t> empty {};
+    const std::vector<std::int64_t> single { 7 };
+    for (const auto& report : { empty, single }) {
+        EXPECT_TRUE(safe(report));
+        EXPECT_TRUE(safe_reference(report));
+        EXPECT_TRUE(almost_safe(report));
+        EXPECT_TRUE(almost_safe_brute_force(report));
+        EXPECT_TRUE(tolerably_safe(report, 1));
+    }
+}
+
+TEST(Reports, ToleranceGeneralizesSafeAndAlmostSafe)
+{
+    std::mt19937_64 rng { 2025 };
+    for (int n { 0 }; n < 200000; ++n) {
+        const auto report = random_report(rng);
+        ASSERT_EQ(tolerably_safe(report, 0), safe(report));
+        ASSERT_EQ(tolerably_safe(report, 1), almost_safe(report));
+    }
+}
+
+TEST(Reports, ToleranceMatchesBruteForce)
+{
+    std::mt19937_64 rng { 2027 };
+    for (int n { 0 }; n < 200000; ++n) {
+        const auto report = random_report(rng);
+        const std::size_t max_removals { 2U + static_cast<std::size_t>(n % 3) };
+        ASSERT_EQ(tolerably_safe(report, max_removals),
+            tolerably_safe_brute_force(report, max_removals));
+    }
+}
+
+TEST(Reports, ToleranceOfSeveralLevels)
+{
+    const std::vector<std::int64_t> report { 1, 9, 2, 9, 3, 4, 9, 5 };
+    EXPECT_FALSE(tolerably_safe(report, 2));
+    EXPECT_TRUE(tolerably_safe(report, 3));
+    EXPECT_TRUE(tolerably_safe(std::vector<std::int64_t> { 4, 4, 4 }, 2));
+    EXPECT_FALSE(tolerably_safe(std::vector<std::int64_t> { 4, 4, 4 }, 1));
+}
+
+TEST(Reports, FirstViolationOnLongReports)
+{
+    std::mt19937_64 rng { 2026 };
+    std::uniform_int_distribution<std::size_t> length_dist { 0, 100 };
+    std::uniform_int_distribution<std::int64_t> step_dist { 1, 3 };
+
+    for (int n { 0 }; n < 20000; ++n) {
+        std::vector<std::int64_t> report(length_dist(rng));
+        for (std::size_t i { 1 }; i < report.size(); ++i) {
+            report[i] = report[i - 1] + step_dist(rng);
+        }
+        std::size_t expected = report.size();
+        if (report.size() >= 2 && n % 4 != 0) {
+            expected = std::uniform_int_distribution<std::size_t> { 0, report.size() - 2 }(rng);
+            for (std::size_t i { expected + 1 }; i < report.size(); ++i) {
+                report[i] += (n % 2 == 0) ? 4 : -3;
+            }
+        }
+
+        ASSERT_EQ(first_violation(report, Direction::Increasing), expected);
+        for (auto& level : report) {
+            level = -level;
+        }
+        ASSERT_EQ(first_violation(report, Direction::Decreasing), expected);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+enum class Effect {
+    Accumulate, // add value(args) to the sums
+    Enable, // enable later Accumulate instructions for part 2
+    Disable, // disable them
+};
+
+// An instruction is written name(a,b,...) with `arity` arguments of one to
+// three digits each.
+struct Instruction {
+    std::string_view name;
+    std::size_t arity;
+    Effect effect;
+    std::int64_t (*value)(std::span<const std::int64_t> args) { nullptr };
+};
+
+// The grammar of the corrupted memory. The scanner's transition table is
+// generated from this at compile time, so a new instruction only needs an
+// entry here. Scanning chunks independently relies on no instruction having
+// the first character of any instruction after its own first character; this
+// is checked at compile time as well.
+inline constexpr std::array instructions {
+    Instruction { "mul", 2, Effect::Accumulate,
+        [](std::span<const std::int64_t> args) { return args[0] * args[1]; } },
+    Instruction { "do", 0, Effect::Enable },
+    Instruction { "don't", 0, Effect::Disable },
+};
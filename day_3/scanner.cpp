@@ -0,0 +1,378 @@
+#include "scanner.hpp"
+#include "instructions.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+constexpr std::size_t max_digits { 3 };
+
+constexpr std::size_t max_arity = [] {
+    std::size_t result { 0 };
+    for (const auto& instruction : instructions) {
+        result = std::max(result, instruction.arity);
+    }
+    return result;
+}();
+
+using Arguments = std::array<std::int64_t, std::max<std::size_t>(max_arity, 1)>;
+
+// The first characters of all instructions, i.e. where a token can start
+constexpr std::array<bool, 256> starts_token = [] {
+    std::array<bool, 256> result {};
+    for (const auto& instruction : instructions) {
+        result[static_cast<unsigned char>(instruction.name.front())] = true;
+    }
+    return result;
+}();
+
+constexpr std::size_t num_start_chars = [] {
+    std::size_t result { 0 };
+    for (const bool b : starts_token) {
+        result += b ? 1 : 0;
+    }
+    return result;
+}();
+
+constexpr std::array<char, num_start_chars> start_chars = [] {
+    std::array<char, num_start_chars> result {};
+    std::size_t n { 0 };
+    for (std::size_t c { 0 }; c < starts_token.size(); ++c) {
+        if (starts_token[c]) {
+            result[n++] = static_cast<char>(c);
+        }
+    }
+    return result;
+}();
+
+// When a partial token breaks, a new one can only start at the offending
+// character if no other character of any token can start one. Then the failure
+// transition of every state is the transition of the start state, the scanner
+// never needs to back up, and a scan that begins inside a token resyncs at the
+// next real one.
+constexpr bool self_synchronising = [] {
+    for (const auto& instruction : instructions) {
+        for (const char c : instruction.name.substr(1)) {
+            if (starts_token[static_cast<unsigned char>(c)]) {
+                return false;
+            }
+        }
+    }
+    for (const char c : std::string_view { "(),0123456789" }) {
+        if (starts_token[static_cast<unsigned char>(c)]) {
+            return false;
+        }
+    }
+    return true;
+}();
+static_assert(self_synchronising, "An instruction contains the first character of an instruction");
+
+// Upper bound on the number of states: the name and '(' of each instruction,
+// then the digits of each argument and the commas between them. Shared name
+// prefixes make the real count smaller.
+constexpr std::size_t num_states = [] {
+    std::size_t result { 1 };
+    for (const auto& instruction : instructions) {
+        result += instruction.name.size() + 1 + instruction.arity * max_digits;
+        result += (instruction.arity > 0) ? instruction.arity - 1 : 0;
+    }
+    return result;
+}();
+
+constexpr std::uint8_t start_state { 0 };
+// Marks a missing edge, so it cannot be the number of a real state
+constexpr std::uint8_t unset_state { 0xFF };
+static_assert(num_states <= unset_state, "Too many scanner states for 8-bit state numbers");
+
+enum class Action : std::uint8_t {
+    None,
+    FirstDigit, // args[operand] = digit
+    NextDigit, // args[operand] = args[operand] * 10 + digit
+    Complete, // instructions[operand] has been read
+};
+
+struct Transition {
+    std::uint8_t next;
+    Action action;
+    std::uint8_t operand;
+};
+
+using Table = std::array<std::array<Transition, 256>, num_states>;
+
+// Builds a trie over "name(" of all instructions followed by one chain of
+// argument states per instruction, then points every missing edge at the
+// start state's edge for the same character.
+constexpr Table make_table()
+{
+    Table table {};
+    for (auto& row : table) {
+        row.fill({ unset_state, Action::None, 0 });
+    }
+    std::size_t used { 1 };
+
+    auto set = [&table](std::size_t from, char c, Transition t) {
+        auto& entry = table[from][static_cast<unsigned char>(c)];
+        if (entry.next != unset_state) {
+            throw "Ambiguous instruction grammar";
+        }
+        entry = t;
+    };
+    auto new_state = [&used] { return static_cast<std::uint8_t>(used++); };
+
+    for (std::size_t index { 0 }; index < instructions.size(); ++index) {
+        const auto& instruction = instructions[index];
+        const Transition complete {
+            start_state, Action::Complete, static_cast<std::uint8_t>(index)
+        };
+
+        std::size_t state { start_state };
+        for (const char c : instruction.name) {
+            const auto& entry = table[state][static_cast<unsigned char>(c)];
+            if (entry.next == unset_state) {
+                set(state, c, { new_state(), Action::None, 0 });
+            }
+            state = table[state][static_cast<unsigned char>(c)].next;
+        }
+        const std::uint8_t open = new_state();
+        set(state, '(', { open, Action::None, 0 });
+        state = open;
+
+        if (instruction.arity == 0) {
+            set(state, ')', complete);
+        }
+        for (std::size_t arg { 0 }; arg < instruction.arity; ++arg) {
+            const auto operand = static_cast<std::uint8_t>(arg);
+            std::array<std::uint8_t, max_digits> digit_states {};
+            for (auto& d : digit_states) {
+                d = new_state();
+            }
+
+            for (char c { '0' }; c <= '9'; ++c) {
+                set(state, c, { digit_states[0], Action::FirstDigit, operand });
+                for (std::size_t k { 1 }; k < max_digits; ++k) {
+                    set(digit_states[k - 1], c, { digit_states[k], Action::NextDigit, operand });
+                }
+            }
+
+            const bool last = (arg + 1 == instruction.arity);
+            const std::uint8_t comma = last ? start_state : new_state();
+            for (const auto d : digit_states) {
+                set(d, last ? ')' : ',', last ? complete : Transition { comma, Action::None, 0 });
+            }
+            state = comma;
+        }
+    }
+
+    for (auto& entry : table[start_state]) {
+        if (entry.next == unset_state) {
+            entry = { start_state, Action::None, 0 };
+        }
+    }
+    for (std::size_t state { 1 }; state < num_states; ++state) {
+        for (std::size_t c { 0 }; c < 256; ++c) {
+            if (table[state][c].next == unset_state) {
+                table[state][c] = table[start_state][c];
+            }
+        }
+    }
+
+    return table;
+}
+
+constexpr Table table = make_table();
+
+// Part 2 state of a chunk under both assumptions about the state at its start
+struct ChunkState {
+    bool if_enabled { true };
+    bool if_disabled { false };
+};
+
+template <std::size_t Index>
+void execute(const Arguments& args, ChunkSummary& summary, ChunkState& state)
+{
+    constexpr Instruction instruction = instructions[Index];
+    if constexpr (instruction.effect == Effect::Accumulate) {
+        const std::int64_t value = instruction.value(std::span { args }.first(instruction.arity));
+        summary.sum_p1 += value;
+        if (state.if_enabled) {
+            summary.sum_if_enabled += value;
+        }
+        if (state.if_disabled) {
+            summary.sum_if_disabled += value;
+        }
+    } else if constexpr (instruction.effect == Effect::Enable) {
+        state = { true, true };
+        summary.final_state = true;
+    } else if constexpr (instruction.effect == Effect::Disable) {
+        state = { false, false };
+        summary.final_state = false;
+    }
+}
+
+// Jumps to the statically known instruction, so each one's semantics are
+// inlined instead of being called through the table
+template <std::size_t... Indices>
+void execute(std::size_t index, const Arguments& args, ChunkSummary& summary, ChunkState& state,
+    std::index_sequence<Indices...>)
+{
+    (void)((index == Indices && (execute<Indices>(args, summary, state), true)) || ...);
+}
+
+// In the start state any byte that cannot start a token leads back to the
+// start state without an action, so the scanner may jump to the next one
+// that can.
+std::size_t next_candidate_scalar(std::string_view memory, std::size_t from)
+{
+    for (std::size_t i { from }; i < memory.size(); ++i) {
+        if (starts_token[static_cast<unsigned char>(memory[i])]) {
+            return i;
+        }
+    }
+    return memory.size();
+}
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) std::uint32_t candidate_mask_avx2(const char* p)
+{
+    const __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+    __m256i hits = _mm256_setzero_si256();
+    for (const char c : start_chars) {
+        hits = _mm256_or_si256(hits, _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(c)));
+    }
+    return static_cast<std::uint32_t>(_mm256_movemask_epi8(hits));
+}
+
+// Tests 64 bytes per iteration, as two 32-byte compares against each start character
+__attribute__((target("avx2"))) std::size_t next_candidate_avx2(
+    std::string_view memory, std::size_t from)
+{
+    const char* p = memory.data();
+    std::size_t i { from };
+    for (; i + 64 <= memory.size(); i += 64) {
+        const std::uint64_t mask = candidate_mask_avx2(p + i)
+            | (static_cast<std::uint64_t>(candidate_mask_avx2(p + i + 32)) << 32);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+    }
+    if (i + 32 <= memory.size()) {
+        const std::uint32_t mask = candidate_mask_avx2(p + i);
+        if (mask != 0) {
+            return i + static_cast<std::size_t>(std::countr_zero(mask));
+        }
+        i += 32;
+    }
+    return next_candidate_scalar(memory, i);
+}
+
+const bool has_avx2 = __builtin_cpu_supports("avx2");
+#endif
+
+std::size_t next_candidate(std::string_view memory, std::size_t from)
+{
+#if defined(__x86_64__)
+    if (has_avx2) {
+        return next_candidate_avx2(memory, from);
+    }
+#endif
+    return next_candidate_scalar(memory, from);
+}
+
+} // namespace
+
+ChunkSummary scan_chunk(std::string_view memory, std::size_t begin, std::size_t end)
+{
+    ChunkSummary summary;
+    ChunkState chunk_state;
+    std::uint8_t state { start_state };
+    Arguments args {};
+
+    const std::string_view owned = memory.substr(0, end);
+    for (std::size_t i { begin }; i < memory.size(); ++i) {
+        if (state == start_state) {
+            i = next_candidate(owned, i);
+            if (i >= end) {
+                break;
+            }
+        }
+
+        const char c = memory[i];
+
+        // Past `end` only the token in progress is finished; one that starts
+        // there belongs to the next chunk
+        if (i >= end && starts_token[static_cast<unsigned char>(c)]) {
+            break;
+        }
+
+        const Transition t = table[state][static_cast<unsigned char>(c)];
+        state = t.next;
+
+        const std::int64_t digit { c - '0' };
+        switch (t.action) {
+        case Action::None:
+            break;
+        case Action::FirstDigit:
+            args[t.operand] = digit;
+            break;
+        case Action::NextDigit:
+            args[t.operand] = args[t.operand] * 10 + digit;
+            break;
+        case Action::Complete:
+            execute(t.operand, args, summary, chunk_state,
+                std::make_index_sequence<instructions.size()> {});
+            break;
+        }
+    }
+
+    return summary;
+}
+
+ScanResult combine(std::span<const ChunkSummary> summaries, bool& enabled)
+{
+    ScanResult result;
+    for (const auto& summary : summaries) {
+        result.sum_p1 += summary.sum_p1;
+        result.sum_p2 += enabled ? summary.sum_if_enabled : summary.sum_if_disabled;
+        enabled = summary.final_state.value_or(enabled);
+    }
+    return result;
+}
+
+ScanResult scan(std::string_view memory, bool& enabled)
+{
+    const ChunkSummary summary = scan_chunk(memory, 0, memory.size());
+    return combine({ &summary, 1 }, enabled);
+}
+
+ScanResult scan_parallel(std::string_view memory, bool& enabled, std::size_t num_chunks)
+{
+    num_chunks = std::clamp<std::size_t>(num_chunks, 1, std::max<std::size_t>(memory.size(), 1));
+    const std::size_t chunk_size = (memory.size() + num_chunks - 1) / num_chunks;
+
+    std::vector<ChunkSummary> summaries(num_chunks);
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t k { 0 }; k < num_chunks; ++k) {
+            const std::size_t begin = std::min(k * chunk_size, memory.size());
+            const std::size_t end = std::min(begin + chunk_size, memory.size());
+            workers.emplace_back([&summaries, memory, k, begin, end] {
+                summaries[k] = scan_chunk(memory, begin, end);
+            });
+        }
+    }
+
+    return combine(summaries, enabled);
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+
+struct ScanResult {
+    std::int64_t sum_p1 { 0 }; // every mul(a,b)
+    std::int64_t sum_p2 { 0 }; // mul(a,b) while enabled by do()/don't()
+};
+
+// What a chunk contributes, for either do()/don't() state at its start
+struct ChunkSummary {
+    std::int64_t sum_p1 { 0 };
+    std::int64_t sum_if_enabled { 0 };
+    std::int64_t sum_if_disabled { 0 };
+    std::optional<bool> final_state; // set by the chunk's last do() or don't()
+};
+
+// Scans corrupted memory for the instructions declared in instructions.hpp
+// (mul(a,b), do() and don't()) in a single pass and accumulates both parts'
+// sums.
+// Bytes that cannot start a token are skipped with AVX2 when available.
+// `enabled` carries the do()/don't() state across calls.
+ScanResult scan(std::string_view memory, bool& enabled);
+
+// Scans the tokens that start in memory[begin, end). A token that straddles
+// `end` is finished by reading past it, and the next chunk skips its tail:
+// no token contains a token's first character after its own first one, so a
+// scan that starts in the middle of one only resyncs at the next real token.
+ChunkSummary scan_chunk(std::string_view memory, std::size_t begin, std::size_t end);
+
+// Folds consecutive chunk summaries in order, starting from `enabled`.
+ScanResult combine(std::span<const ChunkSummary> summaries, bool& enabled);
+
+// Splits memory into num_chunks chunks, scans them on separate threads and
+// combines the summaries.
+ScanResult scan_parallel(std::string_view memory, bool& enabled, std::size_t num_chunks);
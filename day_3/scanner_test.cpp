@@ -0,0 +1,106 @@
+#include "scanner.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <regex>
+#include <string>
+#include <string_view>
+
+namespace {
+
+// The original std::regex based scanner, restricted to three digits per argument
+ScanResult scan_regex(const std::string& line, bool& enabled)
+{
+    const std::regex mul_regex { "mul\\((\\d{1,3}),(\\d{1,3})\\)|do\\(\\)|don't\\(\\)" };
+    ScanResult result;
+
+    for (auto it = std::sregex_iterator(line.begin(), line.end(), mul_regex);
+        it != std::sregex_iterator(); ++it) {
+        const auto& match = *it;
+        if (match.str() == "do()") {
+            enabled = true;
+        } else if (match.str() == "don't()") {
+            enabled = false;
+        } else {
+            const std::int64_t product = std::stoll(match.str(1)) * std::stoll(match.str(2));
+            result.sum_p1 += product;
+            if (enabled) {
+                result.sum_p2 += product;
+            }
+        }
+    }
+
+    return result;
+}
+
+} // namespace
+
+TEST(Scanner, SampleTest)
+{
+    bool enabled { true };
+    const std::string_view part1 {
+        "xmul(2,4)%&mul[3,7]!@^do_not_mul(5,5)+mul(32,64]then(mul(11,8)mul(8,5))"
+    };
+    EXPECT_EQ(scan(part1, enabled).sum_p1, 161);
+
+    enabled = true;
+    const std::string_view part2 {
+        "xmul(2,4)&mul[3,7]!^don't()_mul(5,5)+mul(32,64](mul(11,8)undo()?mul(8,5))"
+    };
+    EXPECT_EQ(scan(part2, enabled).sum_p2, 48);
+}
+
+TEST(Scanner, RejectsLongArguments)
+{
+    bool enabled { true };
+    EXPECT_EQ(scan("mul(1234,5)mul(12,3456)mmul(2,3)ddo()", enabled).sum_p1, 6);
+}
+
+TEST(Scanner, MatchesRegex)
+{
+    // Random strings over the token alphabet, so that partial and overlapping tokens are common
+    const std::string alphabet { "mul(),don't0123456789x" };
+    std::mt19937_64 rng { 2024 };
+    std::uniform_int_distribution<std::size_t> char_dist { 0, alphabet.size() - 1 };
+
+    bool enabled { true };
+    bool enabled_regex { true };
+    for (int n { 0 }; n < 20000; ++n) {
+        std::string line(64, ' ');
+        for (auto& c : line) {
+            c = alphabet[char_dist(rng)];
+        }
+
+        const auto result = scan(line, enabled);
+        const auto expected = scan_regex(line, enabled_regex);
+        ASSERT_EQ(result.sum_p1, expected.sum_p1);
+        ASSERT_EQ(result.sum_p2, expected.sum_p2);
+        ASSERT_EQ(enabled, enabled_regex);
+    }
+}
+
+TEST(Scanner, ChunksMatchSequentialScan)
+{
+    const std::string alphabet { "mul(),don't0123456789x" };
+    std::mt19937_64 rng { 2025 };
+    std::uniform_int_distribution<std::size_t> char_dist { 0, alphabet.size() - 1 };
+
+    std::string memory(4096, ' ');
+    for (auto& c : memory) {
+        c = alphabet[char_dist(rng)];
+    }
+
+    for (const bool start : { true, false }) {
+        bool enabled { start };
+        const auto expected = scan(memory, enabled);
+        for (std::size_t num_chunks { 1 }; num_chunks <= 64; ++num_chunks) {
+            bool chunked_enabled { start };
+            const auto result = scan_parallel(memory, chunked_enabled, num_chunks);
+            ASSERT_EQ(result.sum_p1, expected.sum_p1);
+            ASSERT_EQ(result.sum_p2, expected.sum_p2);
+            ASSERT_EQ(chunked_enabled, enabled);
+        }
+    }
+}
@@ -0,0 +1,438 @@
+#include "word_search.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+Grid read_grid(std::istream& is)
+{
+    Grid grid;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty()) {
+            break;
+        }
+        if (grid.rows == 0) {
+            grid.cols = line.size();
+        } else if (line.size() != grid.cols) {
+            throw std::invalid_argument("Inconsistent line length");
+        }
+        grid.cells += line;
+        ++grid.rows;
+    }
+    return grid;
+}
+
+namespace {
+
+struct Direction {
+    int dr;
+    int dc;
+};
+
+constexpr std::array<Direction, 8> directions { {
+    { 0, 1 },
+    { 0, -1 },
+    { 1, 0 },
+    { -1, 0 },
+    { 1, 1 },
+    { -1, -1 },
+    { 1, -1 },
+    { -1, 1 },
+} };
+
+// Counts the matches that start in rows [band_begin, band_end)
+std::size_t count_str_strided(
+    const Grid& grid, std::string_view word, std::size_t band_begin, std::size_t band_end)
+{
+    // How far the word reaches from its first letter
+    const std::size_t reach = word.size() - 1;
+    if (reach >= grid.rows && reach >= grid.cols) {
+        return 0;
+    }
+
+    const auto cols = static_cast<std::ptrdiff_t>(grid.cols);
+    const char* const cells = grid.cells.data();
+    std::size_t result { 0 };
+    for (std::size_t r { band_begin }; r < band_end; ++r) {
+        // Which vertical and horizontal directions have room for the word
+        const bool up = r >= reach;
+        const bool down = r + reach < grid.rows;
+        for (std::size_t c { 0 }; c < grid.cols; ++c) {
+            const char* const start = cells + r * grid.cols + c;
+            if (*start != word[0]) {
+                continue;
+            }
+            const bool left = c >= reach;
+            const bool right = c + reach < grid.cols;
+
+            for (const auto& d : directions) {
+                const std::ptrdiff_t stride = d.dr * cols + d.dc;
+                const bool fits = (d.dr == 0 || (d.dr > 0 ? down : up))
+                    && (d.dc == 0 || (d.dc > 0 ? right : left));
+                if (!fits) {
+                    continue;
+                }
+
+                std::size_t k { 1 };
+                while (k < word.size()
+                    && start[static_cast<std::ptrdiff_t>(k) * stride] == word[k]) {
+                    ++k;
+                }
+                if (k == word.size()) {
+                    ++result;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+// Bit j is set if cells[j] == letter, for j < n <= 64
+std::uint64_t match_bits(const char* cells, std::size_t n, char letter)
+{
+    std::uint64_t bits { 0 };
+    std::size_t j { 0 };
+#if defined(__SSE2__)
+    // 16 cells per compare; SSE2 is part of the x86-64 baseline
+    const __m128i pattern = _mm_set1_epi8(letter);
+    for (; j + 16 <= n; j += 16) {
+        const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cells + j));
+        const auto mask
+            = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, pattern)));
+        bits |= static_cast<std::uint64_t>(mask) << j;
+    }
+#endif
+    for (; j < n; ++j) {
+        bits |= static_cast<std::uint64_t>(cells[j] == letter) << j;
+    }
+    return bits;
+}
+
+// One bit per cell for each of a few letters, 64 cells per word, covering the
+// grid rows [first_row, last_row). Every row has a zero word on either side, so
+// shifting a row by up to 63 columns either way pulls in zeros at the grid
+// edges without bounds checks.
+class BitPlanes {
+public:
+    BitPlanes(const Grid& grid, std::string_view letters, std::size_t first_row_,
+        std::size_t last_row)
+        : words_per_row { (grid.cols + 63) / 64 }
+        , first_row { first_row_ }
+        , stride { words_per_row + 2 }
+    {
+        for (const char letter : letters) {
+            auto& index = plane_index[static_cast<unsigned char>(letter)];
+            if (index >= 0) {
+                continue;
+            }
+            index = static_cast<int>(planes.size());
+
+            std::vector<std::uint64_t> plane((last_row - first_row) * stride, 0);
+            for (std::size_t r { first_row }; r < last_row; ++r) {
+                const char* const cells = grid.cells.data() + r * grid.cols;
+                std::uint64_t* const bits = plane.data() + (r - first_row) * stride + 1;
+                for (std::size_t w { 0 }; w < words_per_row; ++w) {
+                    const auto width = std::min<std::size_t>(64, grid.cols - 64 * w);
+                    bits[w] = match_bits(cells + 64 * w, width, letter);
+                }
+            }
+            planes.push_back(std::move(plane));
+        }
+    }
+
+    std::size_t words_per_row;
+
+    const std::uint64_t* row(char letter, std::size_t r) const
+    {
+        const auto index
+            = static_cast<std::size_t>(plane_index[static_cast<unsigned char>(letter)]);
+        return planes[index].data() + (r - first_row) * stride + 1;
+    }
+
+    // Bit j of the result is column 64 * w + j + shift of the row
+    static std::uint64_t shifted(const std::uint64_t* row, std::size_t w, int shift)
+    {
+        if (shift == 0) {
+            return row[w];
+        }
+        if (shift > 0) {
+            return (row[w] >> shift) | (row[w + 1] << (64 - shift));
+        }
+        return (row[w] << -shift) | (row[w - 1] >> (64 + shift));
+    }
+
+private:
+    std::size_t first_row;
+    std::size_t stride;
+    std::array<int, 256> plane_index = [] {
+        std::array<int, 256> result {};
+        result.fill(-1);
+        return result;
+    }();
+    std::vector<std::vector<std::uint64_t>> planes;
+};
+
+// For every direction, a start cell matches if letter k of the word is at
+// offset k along the direction: AND together the word's letter planes, each
+// taken k rows down or up and shifted by k columns, then count the bits.
+// Only matches starting in rows [band_begin, band_end) are counted, but the
+// planes also cover a halo of word.size() - 1 rows on either side, so that
+// vertical and diagonal matches reaching into the next band are seen once.
+std::size_t count_str_bitplanes(
+    const Grid& grid, std::string_view word, std::size_t band_begin, std::size_t band_end)
+{
+    const std::size_t reach = word.size() - 1;
+    const BitPlanes planes { grid, word, band_begin - std::min(band_begin, reach),
+        std::min(grid.rows, band_end + reach) };
+
+    std::size_t result { 0 };
+    for (const auto& d : directions) {
+        if ((d.dr != 0 && reach >= grid.rows) || (d.dc != 0 && reach >= grid.cols)) {
+            continue;
+        }
+        const std::size_t row_begin = std::max(band_begin, (d.dr < 0) ? reach : 0);
+        const std::size_t row_end = std::min(band_end, (d.dr > 0) ? grid.rows - reach : grid.rows);
+
+        std::vector<const std::uint64_t*> rows(word.size());
+        for (std::size_t r { row_begin }; r < row_end; ++r) {
+            for (std::size_t k { 0 }; k < word.size(); ++k) {
+                const auto rr
+                    = static_cast<std::ptrdiff_t>(r) + d.dr * static_cast<std::ptrdiff_t>(k);
+                rows[k] = planes.row(word[k], static_cast<std::size_t>(rr));
+            }
+            for (std::size_t w { 0 }; w < planes.words_per_row; ++w) {
+                std::uint64_t match { rows[0][w] };
+                for (std::size_t k { 1 }; k < word.size() && match != 0; ++k) {
+                    match &= BitPlanes::shifted(rows[k], w, d.dc * static_cast<int>(k));
+                }
+                result += static_cast<std::size_t>(std::popcount(match));
+            }
+        }
+    }
+
+    return result;
+}
+
+// With the A in the centre at (r, c), each diagonal needs M at one end and S at
+// the other. The four corner rows are the planes of rows r - 1 and r + 1
+// shifted by one column either way. Counts the centres in rows
+// [band_begin, band_end), with a one row halo.
+std::size_t count_xmas_band(const Grid& grid, std::size_t band_begin, std::size_t band_end)
+{
+    const std::size_t centre_begin = std::max<std::size_t>(band_begin, 1);
+    const std::size_t centre_end = std::min(band_end, grid.rows - 1);
+    if (centre_begin >= centre_end) {
+        return 0;
+    }
+
+    const BitPlanes planes { grid, "MAS", centre_begin - 1, centre_end + 1 };
+    std::size_t count { 0 };
+    for (std::size_t r { centre_begin }; r < centre_end; ++r) {
+        const std::uint64_t* const m_up = planes.row('M', r - 1);
+        const std::uint64_t* const s_up = planes.row('S', r - 1);
+        const std::uint64_t* const a = planes.row('A', r);
+        const std::uint64_t* const m_down = planes.row('M', r + 1);
+        const std::uint64_t* const s_down = planes.row('S', r + 1);
+
+        for (std::size_t w { 0 }; w < planes.words_per_row; ++w) {
+            // Top-left to bottom-right, then bottom-left to top-right
+            const std::uint64_t diag1
+                = (BitPlanes::shifted(m_up, w, -1) & BitPlanes::shifted(s_down, w, 1))
+                | (BitPlanes::shifted(s_up, w, -1) & BitPlanes::shifted(m_down, w, 1));
+            const std::uint64_t diag2
+                = (BitPlanes::shifted(m_down, w, -1) & BitPlanes::shifted(s_up, w, 1))
+                | (BitPlanes::shifted(s_down, w, -1) & BitPlanes::shifted(m_up, w, 1));
+            count += static_cast<std::size_t>(std::popcount(a[w] & diag1 & diag2));
+        }
+    }
+    return count;
+}
+
+// Splits the rows into horizontal bands, counts each band on its own thread
+// and adds up the per-band counts. By default there is one band per hardware
+// thread, though none thinner than min_band_rows.
+template <typename F>
+std::size_t sum_over_bands(std::size_t rows, std::size_t num_bands, F count_band)
+{
+    constexpr std::size_t min_band_rows { 256 };
+    if (num_bands == 0) {
+        num_bands = std::clamp<std::size_t>(
+            rows / min_band_rows, 1, std::max(std::thread::hardware_concurrency(), 1U));
+    }
+    num_bands = std::clamp<std::size_t>(num_bands, 1, rows);
+    if (num_bands == 1) {
+        return count_band(0, rows);
+    }
+
+    const std::size_t band_rows = (rows + num_bands - 1) / num_bands;
+    std::vector<std::size_t> counts(num_bands, 0);
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t b { 0 }; b < num_bands; ++b) {
+            const std::size_t begin = std::min(b * band_rows, rows);
+            const std::size_t end = std::min(begin + band_rows, rows);
+            workers.emplace_back(
+                [&counts, &count_band, b, begin, end] { counts[b] = count_band(begin, end); });
+        }
+    }
+    return std::accumulate(counts.begin(), counts.end(), std::size_t { 0 });
+}
+
+} // namespace
+
+std::size_t count_str(const Grid& grid, std::string_view word, std::size_t num_bands)
+{
+    if (word.empty() || grid.rows == 0 || grid.cols == 0) {
+        return 0;
+    }
+
+    return sum_over_bands(grid.rows, num_bands, [&grid, word](std::size_t begin, std::size_t end) {
+        // Shifts within a row must stay below the word size
+        if (word.size() <= 64) {
+            return count_str_bitplanes(grid, word, begin, end);
+        }
+        return count_str_strided(grid, word, begin, end);
+    });
+}
+
+std::size_t count_xmas(const Grid& grid, std::size_t num_bands)
+{
+    if (grid.rows < 3 || grid.cols < 3) {
+        return 0;
+    }
+
+    return sum_over_bands(grid.rows, num_bands, [&grid](std::size_t begin, std::size_t end) {
+        return count_xmas_band(grid, begin, end);
+    });
+}
+
+WordAutomaton::WordAutomaton(std::span<const std::string> words)
+{
+    for (const auto& word : words) {
+        for (const char c : word) {
+            auto& symbol = symbols[static_cast<unsigned char>(c)];
+            if (symbol == 0) {
+                if (alphabet_size == symbols.size()) {
+                    throw std::invalid_argument("Too many distinct letters");
+                }
+                symbol = static_cast<std::uint8_t>(alphabet_size++);
+            }
+        }
+    }
+
+    // Trie, with 0 as "no edge" since no edge leads back to the root
+    constexpr std::size_t root { 0 };
+    transitions.assign(alphabet_size, root);
+    for (const auto& word : words) {
+        std::size_t state { root };
+        for (const char c : word) {
+            const std::size_t edge = state * alphabet_size + symbols[static_cast<unsigned char>(c)];
+            if (transitions[edge] == root) {
+                transitions[edge] = transitions.size() / alphabet_size;
+                transitions.resize(transitions.size() + alphabet_size, root);
+            }
+            state = transitions[edge];
+        }
+        word_states.push_back(state);
+    }
+
+    // Failure links in breadth-first order, turning missing edges into the
+    // failure state's edges so that step() never has to follow links
+    const std::size_t num_states = transitions.size() / alphabet_size;
+    fail.assign(num_states, root);
+    bfs_order.reserve(num_states);
+    bfs_order.push_back(root);
+    for (std::size_t i { 0 }; i < bfs_order.size(); ++i) {
+        const std::size_t state = bfs_order[i];
+        for (std::size_t symbol { 1 }; symbol < alphabet_size; ++symbol) {
+            std::size_t& next = transitions[state * alphabet_size + symbol];
+            const std::size_t fallback
+                = (state == root) ? root : transitions[fail[state] * alphabet_size + symbol];
+            if (next != root) {
+                fail[next] = fallback;
+                bfs_order.push_back(next);
+            } else {
+                next = fallback;
+            }
+        }
+    }
+}
+
+std::vector<std::size_t> WordAutomaton::count(const Grid& grid) const
+{
+    // Count how often each state is entered, then credit every state with the
+    // visits of the states whose failure chain passes through it; a word occurs
+    // once for each visit to a state whose chain contains the word's state
+    std::vector<std::size_t> visits(fail.size(), 0);
+    if (grid.rows == 0 || grid.cols == 0) {
+        return std::vector<std::size_t>(word_states.size(), 0);
+    }
+
+    auto walk = [&](std::size_t r, std::size_t c, std::ptrdiff_t dr, std::ptrdiff_t dc) {
+        // Walk to the far edge, then back
+        std::size_t state { 0 };
+        std::size_t length { 0 };
+        for (auto rr = static_cast<std::ptrdiff_t>(r), cc = static_cast<std::ptrdiff_t>(c);
+            rr >= 0 && rr < static_cast<std::ptrdiff_t>(grid.rows) && cc >= 0
+            && cc < static_cast<std::ptrdiff_t>(grid.cols);
+            rr += dr, cc += dc, ++length) {
+            state = step(
+                state, grid.at(static_cast<std::size_t>(rr), static_cast<std::size_t>(cc)));
+            ++visits[state];
+        }
+
+        state = 0;
+        for (std::size_t k { length }; k-- > 0;) {
+            const auto rr = static_cast<std::ptrdiff_t>(r) + dr * static_cast<std::ptrdiff_t>(k);
+            const auto cc = static_cast<std::ptrdiff_t>(c) + dc * static_cast<std::ptrdiff_t>(k);
+            state = step(
+                state, grid.at(static_cast<std::size_t>(rr), static_cast<std::size_t>(cc)));
+            ++visits[state];
+        }
+    };
+
+    for (std::size_t r { 0 }; r < grid.rows; ++r) {
+        walk(r, 0, 0, 1); // rows
+        walk(r, 0, 1, 1); // diagonals starting on the left edge
+        walk(r, grid.cols - 1, 1, -1); // anti-diagonals starting on the right edge
+    }
+    for (std::size_t c { 0 }; c < grid.cols; ++c) {
+        walk(0, c, 1, 0); // columns
+        if (c > 0) {
+            walk(0, c, 1, 1); // remaining diagonals, starting on the top edge
+        }
+        if (c + 1 < grid.cols) {
+            walk(0, c, 1, -1);
+        }
+    }
+
+    for (std::size_t i { bfs_order.size() }; i-- > 1;) {
+        const std::size_t state = bfs_order[i];
+        visits[fail[state]] += visits[state];
+    }
+
+    std::vector<std::size_t> result;
+    result.reserve(word_states.size());
+    for (const auto state : word_states) {
+        // The root stands for the empty word, which is not counted
+        result.push_back(state == 0 ? 0 : visits[state]);
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A rectangular letter grid stored row by row in one buffer
+struct Grid {
+    std::size_t rows { 0 };
+    std::size_t cols { 0 };
+    std::string cells;
+
+    char at(std::size_t r, std::size_t c) const
+    {
+        return cells[r * cols + c];
+    }
+};
+
+Grid read_grid(std::istream& is);
+
+// Counts occurrences of `word` in all 8 directions (rows, columns and both
+// diagonals, forwards and backwards) on per-letter bit planes. The grid is
+// split into horizontal bands counted on separate threads; num_bands = 0
+// picks one band per hardware thread.
+std::size_t count_str(const Grid& grid, std::string_view word, std::size_t num_bands = 0);
+
+// Counts the 3x3 squares whose two diagonals both read MAS in either direction.
+std::size_t count_xmas(const Grid& grid, std::size_t num_bands = 0);
+
+// Aho-Corasick automaton over a word list. Counting drives it once along every
+// row, column and diagonal in both directions, so the cost of a grid pass does
+// not depend on the number of words; the counts match count_str() per word.
+class WordAutomaton {
+public:
+    explicit WordAutomaton(std::span<const std::string> words);
+
+    // Occurrences of each word, in the order of the word list
+    std::vector<std::size_t> count(const Grid& grid) const;
+
+private:
+    std::size_t step(std::size_t state, char c) const
+    {
+        return transitions[state * alphabet_size + symbols[static_cast<unsigned char>(c)]];
+    }
+
+    std::array<std::uint8_t, 256> symbols {}; // 0 for letters in no word
+    std::size_t alphabet_size { 1 };
+    std::vector<std::size_t> transitions; // complete goto function, row per state
+    std::vector<std::size_t> bfs_order; // states by depth, root first
+    std::vector<std::size_t> fail;
+    std::vector<std::size_t> word_states; // state reached by each word
+};
@@ -0,0 +1,57 @@
+#include "word_search.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <numeric>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename F>
+void run(const char* name, F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t result = f();
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>12}: {}, {:.1f} ms", name, result, elapsed.count());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 10000;
+
+    std::mt19937_64 rng { 2024 };
+    std::uniform_int_distribution<std::size_t> letter { 0, 3 };
+    Grid grid { size, size, std::string(size * size, ' ') };
+    for (auto& c : grid.cells) {
+        c = "XMAS"[letter(rng)];
+    }
+    std::println("{} x {} grid", size, size);
+
+    run("count_str", [&grid] { return count_str(grid, "XMAS"); });
+    run("count_xmas", [&grid] { return count_xmas(grid); });
+
+    // A dictionary of random words over the grid's letters
+    std::uniform_int_distribution<std::size_t> length { 3, 8 };
+    std::vector<std::string> words(1000);
+    for (auto& word : words) {
+        word.resize(length(rng));
+        for (auto& c : word) {
+            c = "XMAS"[letter(rng)];
+        }
+    }
+    const WordAutomaton automaton { words };
+    run("automaton", [&grid, &automaton] {
+        const auto counts = automaton.count(grid);
+        return std::accumulate(counts.begin(), counts.end(), std::size_t { 0 });
+    });
+
+    return 0;
+}
@@ -0,0 +1,172 @@
+#include "word_search.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+const std::string sample {
+    "MMMSXXMASM\n"
+    "MSAMXMSMSA\n"
+    "AMXSXMAAMM\n"
+    "MSAMASMSMX\n"
+    "XMASAMXAMM\n"
+    "XXAMMXXAMA\n"
+    "SMSMSASXSS\n"
+    "SAXAMASAAA\n"
+    "MAMMMXMMMM\n"
+    "MXMXAXMASX\n"
+};
+
+Grid random_grid(std::size_t rows, std::size_t cols, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<std::size_t> letter { 0, 3 };
+    Grid grid { rows, cols, std::string(rows * cols, ' ') };
+    for (auto& c : grid.cells) {
+        c = "XMAS"[letter(rng)];
+    }
+    return grid;
+}
+
+// Bounds-checked search, one cell and direction at a time
+std::size_t count_str_naive(const Grid& grid, std::string_view word)
+{
+    std::size_t count { 0 };
+    const auto rows = static_cast<std::ptrdiff_t>(grid.rows);
+    const auto cols = static_cast<std::ptrdiff_t>(grid.cols);
+    for (std::ptrdiff_t r { 0 }; r < rows; ++r) {
+        for (std::ptrdiff_t c { 0 }; c < cols; ++c) {
+            for (std::ptrdiff_t dr { -1 }; dr <= 1; ++dr) {
+                for (std::ptrdiff_t dc { -1 }; dc <= 1; ++dc) {
+                    if (dr == 0 && dc == 0) {
+                        continue;
+                    }
+                    std::size_t k { 0 };
+                    for (; k < word.size(); ++k) {
+                        const auto rr = r + dr * static_cast<std::ptrdiff_t>(k);
+                        const auto cc = c + dc * static_cast<std::ptrdiff_t>(k);
+                        if (rr < 0 || rr >= rows || cc < 0 || cc >= cols) {
+                            break;
+                        }
+                        if (grid.at(static_cast<std::size_t>(rr), static_cast<std::size_t>(cc))
+                            != word[k]) {
+                            break;
+                        }
+                    }
+                    if (k == word.size()) {
+                        ++count;
+                    }
+                }
+            }
+        }
+    }
+    return count;
+}
+
+} // namespace
+
+TEST(WordSearch, SampleTest)
+{
+    std::istringstream is { sample };
+    const Grid grid = read_grid(is);
+
+    ASSERT_EQ(count_str(grid, "XMAS"), 18U);
+    ASSERT_EQ(count_xmas(grid), 9U);
+}
+
+TEST(WordSearch, MatchesNaiveSearch)
+{
+    std::mt19937_64 rng { 2024 };
+    for (const auto& [rows, cols] : { std::pair<std::size_t, std::size_t> { 1, 1 }, { 1, 17 },
+             { 3, 3 }, { 4, 70 }, { 70, 4 }, { 65, 130 } }) {
+        const Grid grid = random_grid(rows, cols, rng);
+        for (const std::string_view word : { "XMAS", "SAM", "MM", "X" }) {
+            ASSERT_EQ(count_str(grid, word), count_str_naive(grid, word));
+        }
+    }
+}
+
+TEST(WordSearch, AutomatonMatchesCountStr)
+{
+    std::mt19937_64 rng { 2025 };
+    const std::vector<std::string> words { "XMAS", "SAM", "MAS", "AS", "MM", "X", "XMASAMX",
+        "SAMXMAS", "Q", "" };
+    const WordAutomaton automaton { words };
+
+    for (const auto& [rows, cols] : { std::pair<std::size_t, std::size_t> { 1, 1 }, { 1, 17 },
+             { 3, 3 }, { 4, 70 }, { 70, 4 }, { 65, 130 } }) {
+        const Grid grid = random_grid(rows, cols, rng);
+        const auto counts = automaton.count(grid);
+        for (std::size_t i { 0 }; i < words.size(); ++i) {
+            ASSERT_EQ(counts[i], count_str(grid, words[i]));
+        }
+    }
+}
+
+TEST(WordSearch, BandsCountBoundaryMatchesOnce)
+{
+    std::mt19937_64 rng { 2026 };
+    const Grid grid = random_grid(97, 75, rng);
+    const std::size_t expected = count_str_naive(grid, "XMAS");
+    const std::size_t expected_xmas = count_xmas(grid, 1);
+
+    for (std::size_t num_bands { 1 }; num_bands <= 97; num_bands += 3) {
+        ASSERT_EQ(count_str(grid, "XMAS", num_bands), expected);
+        ASSERT_EQ(count_xmas(grid, num_bands), expected_xmas);
+    }
+}
+
+TEST(WordSearch, LongWordsMatchNaiveSearch)
+{
+    // Words longer than 64 letters take the strided path instead of bit planes
+    std::mt19937_64 rng { 2027 };
+    std::uniform_int_distribution<std::size_t> letter { 0, 3 };
+    std::uniform_int_distribution<std::size_t> position { 0, 99 };
+    std::uniform_int_distribution<int> step { -1, 1 };
+
+    for (const std::size_t length : { 64U, 65U, 66U, 70U }) {
+        std::string word(length, ' ');
+        for (auto& c : word) {
+            c = "XMAS"[letter(rng)];
+        }
+
+        // Plant the word a few times in random directions where it fits
+        Grid grid = random_grid(100, 100, rng);
+        for (int planted { 0 }; planted < 6;) {
+            const auto r = static_cast<std::ptrdiff_t>(position(rng));
+            const auto c = static_cast<std::ptrdiff_t>(position(rng));
+            const std::ptrdiff_t dr = step(rng);
+            const std::ptrdiff_t dc = step(rng);
+            const auto last = static_cast<std::ptrdiff_t>(length) - 1;
+            if ((dr == 0 && dc == 0) || r + dr * last < 0 || r + dr * last >= 100
+                || c + dc * last < 0 || c + dc * last >= 100) {
+                continue;
+            }
+            for (std::ptrdiff_t k { 0 }; k <= last; ++k) {
+                grid.cells[static_cast<std::size_t>((r + dr * k) * 100 + c + dc * k)]
+                    = word[static_cast<std::size_t>(k)];
+            }
+            ++planted;
+        }
+
+        // A run of one letter matches many times, overlapping
+        Grid uniform { 90, 80, std::string(90 * 80, 'X') };
+        uniform.cells[uniform.cells.size() / 2] = 'M';
+        const std::string run(length, 'X');
+
+        const std::size_t expected = count_str_naive(grid, word);
+        const std::size_t expected_run = count_str_naive(uniform, run);
+        ASSERT_GT(expected, 0U);
+        ASSERT_GT(expected_run, 0U);
+        for (const std::size_t num_bands : { 0U, 1U, 2U, 3U, 7U }) {
+            ASSERT_EQ(count_str(grid, word, num_bands), expected);
+            ASSERT_EQ(count_str(uniform, run, num_bands), expected_run);
+        }
+    }
+}
@@ -1,81 +1,57 @@
-#include <algorithm>
-#include <charconv>
-#include <cstdint>
+#include "rules.hpp"
+#include "server.hpp"
+
+#include <cstdlib>
+#include <exception>
 #include <iostream>
-#include <set>
-#include <string>
 #include <string_view>
-#include <utility>
-#include <vector>
 
-std::pair<std::int64_t, std::int64_t> parse_rule(std::string_view line)
-{
-    std::int64_t a{};
-    std::int64_t b{};
-    const auto bar_pos = line.find('|');
-    std::from_chars(line.data(), line.data() + bar_pos, a);
-    std::from_chars(line.data() + bar_pos + 1, line.data() + line.length(), b);
-    return { a, b };
-}
+#include <unistd.h>
 
-std::set<std::pair<std::int64_t, std::int64_t>> parse_rules(std::istream& ifs)
-{
-    std::string line {};
-    std::set<std::pair<std::int64_t, std::int64_t>> rules;
-    while (true) {
-        std::getline(ifs, line);
-        if (line.empty()) {
-            break;
-        }
-        rules.insert(parse_rule(line));
-    }
-    return rules;
-}
+namespace {
 
-std::vector<std::int64_t> parse_update(std::string_view line)
+int serve(int argc, char* argv[])
 {
-    std::vector<std::int64_t> result {};
-    std::string_view::size_type pos { 0 };
-
-    while (pos != std::string_view::npos) {
-        const auto commas_pos = [&line, pos]() {
-            const auto res = line.find(',', pos);
-            return res != std::string_view::npos ? res : line.size();
-        }();
-
-        std::int64_t val { 0 };
-        std::from_chars(line.data() + pos, line.data() + commas_pos, val);
-        result.push_back(val);
-
-        pos = commas_pos < line.size() ? commas_pos + 1 : std::string_view::npos;
+    if (argc != 3 && !(argc == 5 && std::string_view { argv[3] } == "--socket")) {
+        std::cerr << "Usage: " << argv[0] << " --serve <rules file> [--socket <path>]" << std::endl;
+        return EXIT_FAILURE;
     }
 
-    return result;
+    try {
+        RuleServer server { argv[2] };
+        install_reload_signal();
+        ignore_broken_pipe();
+        if (argc == 5) {
+            server.listen(argv[4]);
+        } else {
+            server.serve(STDIN_FILENO, STDOUT_FILENO);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return 0;
 }
 
-int main()
+} // namespace
+
+int main(int argc, char* argv[])
 {
-    const auto rules = parse_rules(std::cin);
-    const auto cmp = [&rules](std::int64_t a, std::int64_t b) -> bool {
-        return rules.contains(std::make_pair(a, b));
-    };
+    if (argc > 1 && std::string_view { argv[1] } == "--serve") {
+        return serve(argc, argv);
+    }
 
-    std::string line;
-    std::int64_t sum_p1 { 0 };
-    std::int64_t sum_p2 { 0 };
-    while (std::getline(std::cin, line)) {
-        auto update = parse_update(line);
+    try {
+        const auto rules = parse_rules(std::cin);
+        auto updates = parse_updates(std::cin);
+        const auto [sum_p1, sum_p2] = sum_middles(rules, updates);
 
-        if (std::ranges::is_sorted(update, cmp)) {
-            sum_p1 += update[update.size() / 2];
-        } else {
-            std::ranges::sort(update, cmp);
-            sum_p2 += update[update.size() / 2];
-        }
+        std::cout << "Part 1 answer: " << sum_p1 << std::endl;
+        std::cout << "Part 2 answer: " << sum_p2 << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
     }
 
-    std::cout << "Part 1 answer: " << sum_p1 << std::endl;
-    std::cout << "Part 2 answer: " << sum_p2 << std::endl;
-
     return 0;
 }
@@ -0,0 +1,212 @@
+#include "rules.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <set>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+void append_update(std::string_view line, std::vector<std::int64_t>& pages)
+{
+    std::string_view::size_type pos { 0 };
+
+    while (pos != std::string_view::npos) {
+        const auto commas_pos = [&line, pos]() {
+            const auto res = line.find(',', pos);
+            return res != std::string_view::npos ? res : line.size();
+        }();
+
+        std::int64_t val { 0 };
+        const auto [ptr, ec] = std::from_chars(line.data() + pos, line.data() + commas_pos, val);
+        if (ec != std::errc {} || ptr != line.data() + commas_pos) {
+            throw std::invalid_argument("Not a valid page number");
+        }
+        if (val < 0 || static_cast<std::size_t>(val) >= max_pages) {
+            throw std::out_of_range("Page number out of range");
+        }
+        pages.push_back(val);
+
+        pos = commas_pos < line.size() ? commas_pos + 1 : std::string_view::npos;
+    }
+}
+
+// Drops the '\r' of a CRLF line ending
+std::string& trim_cr(std::string& line)
+{
+    if (line.ends_with('\r')) {
+        line.pop_back();
+    }
+    return line;
+}
+
+} // namespace
+
+void RuleIndex::add(std::int64_t before, std::int64_t after)
+{
+    if (before < 0 || after < 0 || static_cast<std::size_t>(before) >= max_pages
+        || static_cast<std::size_t>(after) >= max_pages) {
+        throw std::out_of_range("Page number out of range");
+    }
+    successors[static_cast<std::size_t>(before)].set(static_cast<std::size_t>(after));
+}
+
+std::optional<UpdateCheck> check_update(
+    const RuleIndex& rules, std::span<const std::int64_t> update)
+{
+    if (update.empty()) {
+        return std::nullopt;
+    }
+
+    PageSet pages;
+    for (const auto page : update) {
+        pages.set(static_cast<std::size_t>(page));
+    }
+
+    const std::size_t k = update.size();
+    const std::size_t middle_rank = k - 1 - k / 2;
+    PageSet seen_ranks;
+    UpdateCheck result { true, 0 };
+    for (std::size_t i { 0 }; i < k; ++i) {
+        const std::size_t rank = (rules.successors_of(update[i]) & pages).count();
+        if (rank >= k || seen_ranks.test(rank)) {
+            return std::nullopt;
+        }
+        seen_ranks.set(rank);
+
+        result.sorted = result.sorted && (rank == k - 1 - i);
+        if (rank == middle_rank) {
+            result.middle = update[i];
+        }
+    }
+    return result;
+}
+
+UpdateCheck evaluate_update(const RuleIndex& rules, std::span<std::int64_t> update)
+{
+    if (const auto check = check_update(rules, update)) {
+        return *check;
+    }
+
+    const auto cmp
+        = [&rules](std::int64_t a, std::int64_t b) -> bool { return rules.before(a, b); };
+    const bool sorted = std::ranges::is_sorted(update, cmp);
+    if (!sorted) {
+        std::ranges::sort(update, cmp);
+    }
+    return { sorted, update[update.size() / 2] };
+}
+
+std::pair<std::int64_t, std::int64_t> parse_rule(std::string_view line)
+{
+    const auto bar_pos = line.find('|');
+    if (bar_pos == std::string_view::npos) {
+        throw std::invalid_argument("Not a valid rule");
+    }
+
+    const auto parse_page = [](std::string_view text) {
+        std::int64_t val { 0 };
+        const auto [ptr, ec] = std::from_chars(text.data(), text.data() + text.size(), val);
+        if (text.empty() || ec != std::errc {} || ptr != text.data() + text.size()) {
+            throw std::invalid_argument("Not a valid rule");
+        }
+        return val;
+    };
+    return { parse_page(line.substr(0, bar_pos)), parse_page(line.substr(bar_pos + 1)) };
+}
+
+RuleIndex parse_rules(std::istream& is)
+{
+    std::string line {};
+    RuleIndex rules;
+    while (std::getline(is, line) && !trim_cr(line).empty()) {
+        const auto [a, b] = parse_rule(line);
+        rules.add(a, b);
+    }
+    return rules;
+}
+
+std::set<std::pair<std::int64_t, std::int64_t>> parse_rule_set(std::istream& is)
+{
+    std::string line {};
+    std::set<std::pair<std::int64_t, std::int64_t>> rules;
+    while (std::getline(is, line) && !trim_cr(line).empty()) {
+        rules.insert(parse_rule(line));
+    }
+    return rules;
+}
+
+std::vector<std::int64_t> parse_update(std::string_view line)
+{
+    std::vector<std::int64_t> result {};
+    append_update(line, result);
+    return result;
+}
+
+UpdateList parse_updates(std::istream& is)
+{
+    UpdateList updates;
+    std::string line;
+    while (std::getline(is, line)) {
+        if (trim_cr(line).empty()) {
+            continue;
+        }
+        append_update(line, updates.pages);
+        updates.offsets.push_back(updates.pages.size());
+    }
+    return updates;
+}
+
+MiddleSums sum_middles(const RuleIndex& rules, UpdateList& updates, std::size_t num_threads)
+{
+    const auto sum_range = [&rules, &updates](std::size_t begin, std::size_t end) {
+        MiddleSums sums { 0, 0 };
+        for (std::size_t i { begin }; i < end; ++i) {
+            const auto [sorted, middle] = evaluate_update(rules, updates[i]);
+            (sorted ? sums.sum_p1 : sums.sum_p2) += middle;
+        }
+        return sums;
+    };
+
+    // An update takes well under a microsecond; smaller shares are not worth
+    // a thread
+    constexpr std::size_t min_share { 16384 };
+    const std::size_t count = updates.size();
+    if (num_threads == 0) {
+        num_threads = std::clamp<std::size_t>(
+            count / min_share, 1, std::max(std::thread::hardware_concurrency(), 1U));
+    }
+    num_threads = std::clamp<std::size_t>(num_threads, 1, std::max<std::size_t>(count, 1));
+    if (num_threads == 1) {
+        return sum_range(0, count);
+    }
+
+    const std::size_t share = (count + num_threads - 1) / num_threads;
+    std::vector<MiddleSums> partial(num_threads);
+    {
+        std::vector<std::jthread> workers;
+        for (std::size_t t { 0 }; t < num_threads; ++t) {
+            const std::size_t begin = std::min(t * share, count);
+            const std::size_t end = std::min(begin + share, count);
+            workers.emplace_back(
+                [&partial, &sum_range, t, begin, end] { partial[t] = sum_range(begin, end); });
+        }
+    }
+
+    MiddleSums sums { 0, 0 };
+    for (const auto& p : partial) {
+        sums.sum_p1 += p.sum_p1;
+        sums.sum_p2 += p.sum_p2;
+    }
+    return sums;
+}
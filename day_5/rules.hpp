@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <istream>
+#include <optional>
+#include <set>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Page numbers are below this bound
+inline constexpr std::size_t max_pages { 128 };
+
+using PageSet = std::bitset<max_pages>;
+
+// The page ordering rules as a dense bit matrix: row a has bit b set if there
+// is a rule a|b. A row is 16 bytes, so the whole index is 2 KiB and a lookup
+// is a single bit test.
+class RuleIndex {
+public:
+    void add(std::int64_t before, std::int64_t after);
+
+    bool before(std::int64_t a, std::int64_t b) const
+    {
+        return successors[static_cast<std::size_t>(a)][static_cast<std::size_t>(b)];
+    }
+
+    const PageSet& successors_of(std::int64_t page) const
+    {
+        return successors[static_cast<std::size_t>(page)];
+    }
+
+private:
+    std::array<PageSet, max_pages> successors {};
+};
+
+struct UpdateCheck {
+    bool sorted;
+    std::int64_t middle;
+};
+
+// Finds whether an update is in order and its middle page without sorting it.
+// When the rules order the update's pages totally, a page's position in the
+// sorted update is given by how many of the update's pages must come after it,
+// i.e. the popcount of its successor row intersected with the update's page
+// set. The update is sorted if those ranks strictly decrease along it. Returns
+// nothing if the ranks are not all distinct, in which case the rules do not
+// order the update and the caller has to sort it. O(k * max_pages / 64).
+std::optional<UpdateCheck> check_update(
+    const RuleIndex& rules, std::span<const std::int64_t> update);
+
+// check_update(), falling back to is_sorted and sort (which reorders `update`)
+// when the rules do not order the update totally
+UpdateCheck evaluate_update(const RuleIndex& rules, std::span<std::int64_t> update);
+
+// A "before|after" line. Throws std::invalid_argument on anything else
+std::pair<std::int64_t, std::int64_t> parse_rule(std::string_view line);
+
+// A batch of updates in one buffer: update i is pages[offsets[i], offsets[i + 1])
+struct UpdateList {
+    std::vector<std::int64_t> pages;
+    std::vector<std::size_t> offsets { 0 };
+
+    std::size_t size() const { return offsets.size() - 1; }
+
+    std::span<std::int64_t> operator[](std::size_t i)
+    {
+        return { pages.data() + offsets[i], offsets[i + 1] - offsets[i] };
+    }
+};
+
+struct MiddleSums {
+    std::int64_t sum_p1;
+    std::int64_t sum_p2;
+};
+
+// Sums the middle pages of sorted (part 1) and reordered (part 2) updates.
+// The updates are split into contiguous ranges evaluated on separate threads
+// that share the read-only index; each range keeps its own sums and they are
+// added up at the end. `num_threads` 0 picks one thread per hardware thread,
+// bounded so that each gets a useful share of the updates. Reorders `updates`.
+MiddleSums sum_middles(const RuleIndex& rules, UpdateList& updates, std::size_t num_threads = 0);
+
+// Reads rules up to the first empty line. A trailing '\r' is ignored.
+RuleIndex parse_rules(std::istream& is);
+
+// The rules as an ordered set of pairs, as before the bit matrix; kept for the
+// benchmark
+std::set<std::pair<std::int64_t, std::int64_t>> parse_rule_set(std::istream& is);
+
+// Comma separated page numbers. Throws std::invalid_argument on anything else
+// and std::out_of_range for pages that do not fit the index.
+std::vector<std::int64_t> parse_update(std::string_view line);
+
+// Reads the remaining lines of `is` as updates, without a vector per update.
+// Blank lines are skipped and a trailing '\r' is ignored.
+UpdateList parse_updates(std::istream& is);
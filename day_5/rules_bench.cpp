@@ -0,0 +1,117 @@
+#include "rules.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <numeric>
+#include <print>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Rules for every pair of a random permutation of 100 pages, like the puzzle
+// input, and random updates of odd length drawn from those pages
+struct Workload {
+    std::string rules;
+    std::vector<std::vector<std::int64_t>> updates;
+};
+
+Workload make_workload(std::size_t num_updates, std::mt19937_64& rng)
+{
+    std::vector<std::int64_t> order(100);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::shuffle(order, rng);
+
+    Workload workload;
+    for (std::size_t i { 0 }; i < order.size(); ++i) {
+        for (std::size_t j { i + 1 }; j < order.size(); ++j) {
+            workload.rules += std::to_string(order[i]) + "|" + std::to_string(order[j]) + "\n";
+        }
+    }
+    workload.rules += "\n";
+
+    std::uniform_int_distribution<std::size_t> half_length { 2, 11 };
+    workload.updates.resize(num_updates);
+    for (auto& update : workload.updates) {
+        std::vector<std::int64_t> pages = order;
+        std::ranges::shuffle(pages, rng);
+        pages.resize(2 * half_length(rng) + 1);
+        update = std::move(pages);
+    }
+    return workload;
+}
+
+template <typename Cmp>
+void run(const char* name, const std::vector<std::vector<std::int64_t>>& updates, Cmp cmp)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::int64_t sum_p1 { 0 };
+    std::int64_t sum_p2 { 0 };
+    for (auto update : updates) {
+        if (std::ranges::is_sorted(update, cmp)) {
+            sum_p1 += update[update.size() / 2];
+        } else {
+            std::ranges::sort(update, cmp);
+            sum_p2 += update[update.size() / 2];
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>10}: {} {}, {:.1f} ms", name, sum_p1, sum_p2, elapsed.count());
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t num_updates = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::mt19937_64 rng { 2024 };
+    const auto workload = make_workload(num_updates, rng);
+    std::println("{} updates", num_updates);
+
+    std::istringstream rule_stream { workload.rules };
+    const auto rule_set = parse_rule_set(rule_stream);
+    rule_stream.clear();
+    rule_stream.seekg(0);
+    const auto rule_index = parse_rules(rule_stream);
+
+    run("std::set", workload.updates,
+        [&rule_set](std::int64_t a, std::int64_t b) { return rule_set.contains({ a, b }); });
+    run("bit matrix", workload.updates,
+        [&rule_index](std::int64_t a, std::int64_t b) { return rule_index.before(a, b); });
+
+    const auto start = std::chrono::steady_clock::now();
+    std::int64_t sum_p1 { 0 };
+    std::int64_t sum_p2 { 0 };
+    for (const auto& update : workload.updates) {
+        const auto check = check_update(rule_index, update).value();
+        (check.sorted ? sum_p1 : sum_p2) += check.middle;
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>10}: {} {}, {:.1f} ms", "ranks", sum_p1, sum_p2, elapsed.count());
+
+    UpdateList flat;
+    for (const auto& update : workload.updates) {
+        flat.pages.insert(flat.pages.end(), update.begin(), update.end());
+        flat.offsets.push_back(flat.pages.size());
+    }
+    for (const std::size_t num_threads : { 1U, 2U, 4U, 8U }) {
+        auto updates = flat;
+        const auto threads_start = std::chrono::steady_clock::now();
+        const auto sums = sum_middles(rule_index, updates, num_threads);
+        const std::chrono::duration<double, std::milli> threads_elapsed
+            = std::chrono::steady_clock::now() - threads_start;
+        std::println("{:>7} x{}: {} {}, {:.1f} ms", "threads", num_threads, sums.sum_p1,
+            sums.sum_p2, threads_elapsed.count());
+    }
+
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "rules.hpp"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+TEST(Rules, CheckUpdateSample)
+{
+    RuleIndex rules;
+    for (const auto& [a, b] : std::vector<std::pair<std::int64_t, std::int64_t>> { { 47, 53 },
+             { 97, 13 }, { 97, 61 }, { 97, 47 }, { 75, 29 }, { 61, 13 }, { 75, 53 }, { 29, 13 },
+             { 97, 29 }, { 53, 29 }, { 61, 53 }, { 97, 53 }, { 61, 29 }, { 47, 13 }, { 75, 47 },
+             { 97, 75 }, { 47, 61 }, { 75, 61 }, { 47, 29 }, { 75, 13 }, { 53, 13 } }) {
+        rules.add(a, b);
+    }
+
+    const auto sorted = check_update(rules, std::vector<std::int64_t> { 75, 47, 61, 53, 29 });
+    ASSERT_TRUE(sorted.has_value());
+    EXPECT_TRUE(sorted->sorted);
+    EXPECT_EQ(sorted->middle, 61);
+
+    const auto unsorted = check_update(rules, std::vector<std::int64_t> { 97, 13, 75, 29, 47 });
+    ASSERT_TRUE(unsorted.has_value());
+    EXPECT_FALSE(unsorted->sorted);
+    EXPECT_EQ(unsorted->middle, 47);
+}
+
+TEST(Rules, CheckUpdateMatchesSort)
+{
+    std::mt19937_64 rng { 2024 };
+    std::vector<std::int64_t> order(100);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::shuffle(order, rng);
+
+    RuleIndex rules;
+    for (std::size_t i { 0 }; i < order.size(); ++i) {
+        for (std::size_t j { i + 1 }; j < order.size(); ++j) {
+            rules.add(order[i], order[j]);
+        }
+    }
+    const auto cmp = [&rules](std::int64_t a, std::int64_t b) { return rules.before(a, b); };
+
+    std::uniform_int_distribution<std::size_t> length { 1, 99 };
+    for (int n { 0 }; n < 2000; ++n) {
+        std::vector<std::int64_t> update = order;
+        std::ranges::shuffle(update, rng);
+        update.resize(length(rng));
+        if (n % 3 == 0) {
+            std::ranges::sort(update, cmp);
+        }
+
+        const auto check = check_update(rules, update);
+        ASSERT_TRUE(check.has_value());
+        EXPECT_EQ(check->sorted, std::ranges::is_sorted(update, cmp));
+        std::ranges::sort(update, cmp);
+        EXPECT_EQ(check->middle, update[update.size() / 2]);
+    }
+}
+
+TEST(Rules, CheckUpdateRejectsCycles)
+{
+    RuleIndex rules;
+    rules.add(1, 2);
+    rules.add(2, 3);
+    rules.add(3, 1);
+    EXPECT_FALSE(check_update(rules, std::vector<std::int64_t> { 1, 2, 3 }).has_value());
+}
+
+TEST(Rules, SumMiddlesAnyThreadCount)
+{
+    std::mt19937_64 rng { 7 };
+    std::vector<std::int64_t> order(100);
+    std::iota(order.begin(), order.end(), 0);
+    std::ranges::shuffle(order, rng);
+
+    RuleIndex rules;
+    for (std::size_t i { 0 }; i < order.size(); ++i) {
+        for (std::size_t j { i + 1 }; j < order.size(); ++j) {
+            rules.add(order[i], order[j]);
+        }
+    }
+
+    std::string text;
+    std::uniform_int_distribution<std::size_t> length { 1, 23 };
+    for (int n { 0 }; n < 1000; ++n) {
+        std::vector<std::int64_t> update = order;
+        std::ranges::shuffle(update, rng);
+        update.resize(length(rng));
+        for (std::size_t i { 0 }; i < update.size(); ++i) {
+            text += (i == 0 ? "" : ",") + std::to_string(update[i]);
+        }
+        text += "\n";
+    }
+
+    std::istringstream serial_stream { text };
+    MiddleSums expected { 0, 0 };
+    for (std::string line; std::getline(serial_stream, line);) {
+        auto update = parse_update(line);
+        const auto [sorted, middle] = evaluate_update(rules, update);
+        (sorted ? expected.sum_p1 : expected.sum_p2) += middle;
+    }
+
+    for (const std::size_t num_threads : { 1U, 2U, 3U, 8U, 1000U, 5000U }) {
+        std::istringstream stream { text };
+        auto updates = parse_updates(stream);
+        ASSERT_EQ(updates.size(), 1000U);
+        const auto sums = sum_middles(rules, updates, num_threads);
+        EXPECT_EQ(sums.sum_p1, expected.sum_p1);
+        EXPECT_EQ(sums.sum_p2, expected.sum_p2);
+    }
+}
+
+TEST(Rules, ParseUpdatesSkipsBlankAndCrLfLines)
+{
+    std::istringstream stream { "75,47,61\r\n\n97,13\n\r\n" };
+    auto updates = parse_updates(stream);
+    ASSERT_EQ(updates.size(), 2U);
+    EXPECT_EQ(updates[0].size(), 3U);
+    EXPECT_EQ(updates[1][1], 13);
+}
+
+TEST(Rules, ParseRulesWithCrLfLines)
+{
+    std::istringstream stream { "47|53\r\n97|47\r\n\r\n97,47,53\r\n" };
+    const auto rules = parse_rules(stream);
+    EXPECT_TRUE(rules.before(47, 53));
+    EXPECT_TRUE(rules.before(97, 47));
+    auto updates = parse_updates(stream);
+    ASSERT_EQ(updates.size(), 1U);
+    EXPECT_EQ(updates[0][2], 53);
+
+    std::istringstream set_stream { "47|53\r\n\r\n" };
+    EXPECT_EQ(parse_rule_set(set_stream).size(), 1U);
+}
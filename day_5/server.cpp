@@ -0,0 +1,332 @@
+#include "server.hpp"
+
+#include "rules.hpp"
+
+#include <array>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stop_token>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+volatile std::sig_atomic_t reload_requested { 0 };
+
+void on_sighup(int)
+{
+    reload_requested = 1;
+}
+
+[[noreturn]] void throw_errno(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+RuleIndex load_rules(const std::string& path)
+{
+    std::ifstream ifs { path };
+    if (!ifs) {
+        throw std::runtime_error(std::format("Cannot open {}", path));
+    }
+    return parse_rules(ifs);
+}
+
+void write_all(int fd, std::string_view data)
+{
+    while (!data.empty()) {
+        const ::ssize_t n = ::write(fd, data.data(), data.size());
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw_errno("write");
+        }
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+}
+
+// Both ends of a pipe, closed on destruction
+struct Pipe {
+    Pipe()
+    {
+        if (::pipe(fds.data()) != 0) {
+            throw_errno("pipe");
+        }
+    }
+    Pipe(const Pipe&) = delete;
+    Pipe& operator=(const Pipe&) = delete;
+    ~Pipe()
+    {
+        ::close(fds[0]);
+        ::close(fds[1]);
+    }
+
+    std::array<int, 2> fds {};
+};
+
+// A connection accepted by RuleServer::listen()
+struct Client {
+    int fd;
+    // Start of a request line that has not been completed yet
+    std::string pending;
+    // Replies the socket has not taken yet
+    std::string replies;
+    // The client has closed its end; it is dropped once its replies are out
+    bool closing;
+};
+
+// Replies a client may leave uncollected before its requests are left unread
+constexpr std::size_t max_backlog { 1 << 20 };
+
+// Sends as much of `data` as the socket takes without blocking and removes it
+// from `data`. Returns false if the client is gone.
+bool send_some(int fd, std::string& data)
+{
+    while (!data.empty()) {
+        const ::ssize_t n = ::send(fd, data.data(), data.size(), MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        data.erase(0, static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+} // namespace
+
+void install_reload_signal()
+{
+    // No SA_RESTART, so that a blocked read() returns and the reload happens
+    // right away rather than with the next request
+    struct sigaction action { };
+    action.sa_handler = on_sighup;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGHUP, &action, nullptr);
+}
+
+void ignore_broken_pipe()
+{
+    // A client that hangs up before its replies are written makes write()
+    // fail with EPIPE instead of killing the server
+    ::signal(SIGPIPE, SIG_IGN);
+}
+
+RuleServer::RuleServer(std::string rule_path_)
+    : rule_path { std::move(rule_path_) }
+    , rules { load_rules(rule_path) }
+{
+}
+
+void RuleServer::reload(const std::string& path)
+{
+    rules = load_rules(path);
+    rule_path = path;
+}
+
+std::string RuleServer::reload_if_requested()
+{
+    if (reload_requested == 0) {
+        return {};
+    }
+    reload_requested = 0;
+    try {
+        reload(rule_path);
+    } catch (const std::exception& e) {
+        return std::format("error {}\n", e.what());
+    }
+    return {};
+}
+
+std::string RuleServer::handle(std::string_view line, Origin origin)
+{
+    if (line == "reload" || line.starts_with("reload ")) {
+        std::string_view path = line.substr(6);
+        while (path.starts_with(' ')) {
+            path.remove_prefix(1);
+        }
+        // The server would open the file with its own permissions, on behalf
+        // of anyone who can connect
+        if (!path.empty() && origin == Origin::Socket) {
+            throw std::invalid_argument("Only the current rule file can be reloaded");
+        }
+        const std::string new_path = path.empty() ? rule_path : std::string { path };
+        reload(new_path);
+        return std::format("reloaded {}\n", new_path);
+    }
+
+    auto update = parse_update(line);
+    const auto [sorted, middle] = evaluate_update(rules, update);
+    return std::format("{} {}\n", sorted ? "valid" : "invalid", middle);
+}
+
+void RuleServer::answer(std::string& pending, std::string& replies, Origin origin)
+{
+    std::size_t line_start { 0 };
+    for (auto eol = pending.find('\n'); eol != std::string::npos;
+         eol = pending.find('\n', line_start)) {
+        std::string_view line { pending.data() + line_start, eol - line_start };
+        line_start = eol + 1;
+        if (line.ends_with('\r')) {
+            line.remove_suffix(1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+
+        try {
+            replies += handle(line, origin);
+        } catch (const std::exception& e) {
+            replies += std::format("error {}\n", e.what());
+        }
+    }
+    pending.erase(0, line_start);
+}
+
+void RuleServer::serve(int in_fd, int out_fd)
+{
+    std::array<char, 1 << 16> chunk;
+    std::string pending;
+    std::string replies;
+
+    while (true) {
+        if (const auto error = reload_if_requested(); !error.empty()) {
+            write_all(out_fd, error);
+        }
+
+        const ::ssize_t n = ::read(in_fd, chunk.data(), chunk.size());
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            throw_errno("read");
+        }
+        if (n == 0) {
+            return;
+        }
+
+        pending.append(chunk.data(), static_cast<std::size_t>(n));
+        answer(pending, replies, Origin::Operator);
+        write_all(out_fd, replies);
+        replies.clear();
+    }
+}
+
+void RuleServer::listen(const std::string& socket_path, std::stop_token stop)
+{
+    ::sockaddr_un address { };
+    address.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("Socket path too long");
+    }
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    // Written to when `stop` is requested, to wake up poll()
+    const Pipe wake;
+
+    const int server_fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server_fd < 0) {
+        throw_errno("socket");
+    }
+    ::unlink(socket_path.c_str());
+    // Only the owner may connect, whatever the umask. Connections are refused
+    // until listen(), so nobody gets in before the mode is set.
+    if (::bind(server_fd, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)) != 0
+        || ::chmod(socket_path.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(server_fd, 16) != 0) {
+        ::close(server_fd);
+        throw_errno("bind");
+    }
+
+    // Declared after `wake`, so it is gone before the pipe is closed
+    const std::stop_callback on_stop { stop, [&wake] {
+        const char byte { 0 };
+        [[maybe_unused]] const auto n = ::write(wake.fds[1], &byte, 1);
+    } };
+
+    std::vector<Client> clients;
+    std::vector<::pollfd> fds;
+    const auto close_all = [&] {
+        for (const auto& client : clients) {
+            ::close(client.fd);
+        }
+        ::close(server_fd);
+    };
+
+    std::array<char, 1 << 16> chunk;
+    while (!stop.stop_requested()) {
+        fds.clear();
+        fds.push_back({ server_fd, POLLIN, 0 });
+        fds.push_back({ wake.fds[0], POLLIN, 0 });
+        for (const auto& client : clients) {
+            // Requests of a client that does not collect its replies wait
+            const bool can_read = !client.closing && client.replies.size() < max_backlog;
+            const auto events = (can_read ? POLLIN : 0) | (client.replies.empty() ? 0 : POLLOUT);
+            fds.push_back({ client.fd, static_cast<short>(events), 0 });
+        }
+
+        if (::poll(fds.data(), fds.size(), -1) < 0) {
+            if (errno == EINTR) {
+                // Interrupted by SIGHUP. A failed reload keeps the old rules,
+                // and there is no client to tell
+                reload_if_requested();
+                continue;
+            }
+            close_all();
+            throw_errno("poll");
+        }
+
+        for (std::size_t i { 0 }; i < clients.size(); ++i) {
+            auto& client = clients[i];
+            const short revents = fds[i + 2].revents;
+            bool gone = (revents & (POLLERR | POLLNVAL)) != 0;
+            if (!gone && (revents & POLLIN) != 0) {
+                const ::ssize_t n = ::recv(client.fd, chunk.data(), chunk.size(), MSG_DONTWAIT);
+                if (n > 0) {
+                    client.pending.append(chunk.data(), static_cast<std::size_t>(n));
+                    answer(client.pending, client.replies, Origin::Socket);
+                } else if (n == 0) {
+                    client.closing = true;
+                } else {
+                    gone = errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK;
+                }
+            }
+            if (!gone && (revents & (POLLIN | POLLOUT | POLLHUP)) != 0) {
+                gone = !send_some(client.fd, client.replies);
+            }
+            if (gone || (client.closing && client.replies.empty())) {
+                ::close(client.fd);
+                client.fd = -1;
+            }
+        }
+        std::erase_if(clients, [](const Client& client) { return client.fd < 0; });
+
+        if ((fds[0].revents & POLLIN) != 0) {
+            const int client_fd = ::accept(server_fd, nullptr, nullptr);
+            if (client_fd >= 0) {
+                clients.push_back({ client_fd, {}, {}, false });
+            } else if (errno != EINTR && errno != ECONNABORTED) {
+                close_all();
+                throw_errno("accept");
+            }
+        }
+    }
+
+    close_all();
+    ::unlink(socket_path.c_str());
+}
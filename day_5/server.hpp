@@ -0,0 +1,52 @@
+#pragma once
+
+#include "rules.hpp"
+
+#include <stop_token>
+#include <string>
+#include <string_view>
+
+// Keeps compiled rules in memory and answers update queries, one per line:
+//   a,b,c,...      ->  "valid <middle>" or "invalid <middle of the sorted update>"
+//   reload [file]  ->  "reloaded <file>", re-reading the rule file (or a new one)
+// Only the operator, on stdin, may name a new file; socket clients can only
+// have the current one re-read.
+// Malformed lines get "error <reason>". Replies to everything that arrived in
+// one read are written together, so a batch costs one write. SIGHUP also
+// reloads the current rule file. A failed reload keeps the old rules.
+class RuleServer {
+public:
+    explicit RuleServer(std::string rule_path);
+
+    // Serves the operator, e.g. on stdin and stdout, until the input ends
+    void serve(int in_fd, int out_fd);
+
+    // Serves the clients of a Unix socket at `socket_path` side by side on one
+    // thread, so a client that stays idle or is slow to collect its replies
+    // does not hold up the others. Reloads happen on the same thread, between
+    // requests. Only the owner may connect to the socket. Returns, removing
+    // the socket, once `stop` is requested.
+    void listen(const std::string& socket_path, std::stop_token stop = {});
+
+private:
+    // Who sent a request line: the operator may name a new rule file
+    enum class Origin { Operator, Socket };
+
+    // Answers the complete lines at the start of `pending`, removing them and
+    // appending the replies to `replies`
+    void answer(std::string& pending, std::string& replies, Origin origin);
+    std::string handle(std::string_view line, Origin origin);
+    void reload(const std::string& path);
+    // Applies a reload requested by SIGHUP, returning the error reply if it failed
+    std::string reload_if_requested();
+
+    std::string rule_path;
+    RuleIndex rules;
+};
+
+// Installs the SIGHUP handler used for reloading
+void install_reload_signal();
+
+// Ignores SIGPIPE, so that a client closing its end early is an error for that
+// client only
+void ignore_broken_pipe();
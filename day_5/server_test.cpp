@@ -0,0 +1,212 @@
+#include "server.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+// Sends `requests` through a pipe to the server and collects its replies
+std::string exchange(RuleServer& server, std::string_view requests)
+{
+    std::array<int, 2> in {};
+    std::array<int, 2> out {};
+    EXPECT_EQ(::pipe(in.data()), 0);
+    EXPECT_EQ(::pipe(out.data()), 0);
+
+    EXPECT_EQ(::write(in[1], requests.data(), requests.size()),
+        static_cast<::ssize_t>(requests.size()));
+    ::close(in[1]);
+    server.serve(in[0], out[1]);
+    ::close(in[0]);
+    ::close(out[1]);
+
+    std::string replies;
+    std::array<char, 4096> chunk;
+    for (::ssize_t n; (n = ::read(out[0], chunk.data(), chunk.size())) > 0;) {
+        replies.append(chunk.data(), static_cast<std::size_t>(n));
+    }
+    ::close(out[0]);
+    return replies;
+}
+
+void write_file(const std::string& path, std::string_view contents)
+{
+    std::ofstream { path } << contents;
+}
+
+// Connects to the socket of a server started on another thread, waiting for it
+// to appear
+int connect_to(const std::string& socket_path)
+{
+    ::sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+    for (int attempt { 0 }; attempt < 500; ++attempt) {
+        const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (::connect(fd, reinterpret_cast<const ::sockaddr*>(&address), sizeof(address)) == 0) {
+            return fd;
+        }
+        ::close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds { 10 });
+    }
+    return -1;
+}
+
+// Reads one reply line, giving up after a few seconds
+std::string read_reply(int fd)
+{
+    std::string reply;
+    while (!reply.ends_with('\n')) {
+        ::pollfd ready { fd, POLLIN, 0 };
+        char c {};
+        if (::poll(&ready, 1, 5000) != 1 || ::read(fd, &c, 1) != 1) {
+            break;
+        }
+        reply += c;
+    }
+    return reply;
+}
+
+} // namespace
+
+TEST(RuleServer, AnswersAndReloads)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_test.txt";
+    write_file(path, "47|53\n97|13\n97|61\n97|47\n75|29\n61|13\n75|53\n29|13\n97|29\n53|29\n61|53\n"
+                     "97|53\n61|29\n47|13\n75|47\n97|75\n47|61\n75|61\n47|29\n75|13\n53|13\n\n");
+    RuleServer server { path };
+
+    EXPECT_EQ(exchange(server, "75,47,61,53,29\n97,13,75,29,47\n75,x\n"),
+        "valid 61\ninvalid 47\nerror Not a valid page number\n");
+
+    write_file(path, "47|75\n\n");
+    EXPECT_EQ(exchange(server, "75,47\nreload\n75,47\n"),
+        "valid 47\nreloaded " + path + "\ninvalid 75\n");
+    EXPECT_EQ(exchange(server, "reload /nonexistent/rules.txt\n75,47\n"),
+        "error Cannot open /nonexistent/rules.txt\ninvalid 75\n");
+    EXPECT_EQ(exchange(server, "reloadfoo\n"), "error Not a valid page number\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(RuleServer, RuleFileWithoutFinalNewline)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_no_newline.txt";
+    write_file(path, "47|75");
+    RuleServer server { path };
+
+    EXPECT_EQ(exchange(server, "75,47\nreload\n47,75\n"),
+        "invalid 75\nreloaded " + path + "\nvalid 75\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(RuleServer, RuleFileWithCrLfLines)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_crlf.txt";
+    write_file(path, "47|75\r\n\r\n");
+    RuleServer server { path };
+
+    EXPECT_EQ(exchange(server, "75,47\r\nreload\r\n47,75\r\n"),
+        "invalid 75\nreloaded " + path + "\nvalid 75\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(RuleServer, MalformedRuleFileKeepsOldRules)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_malformed.txt";
+    write_file(path, "47|75\n\n");
+    RuleServer server { path };
+
+    for (const std::string_view contents : { "garbage\n", "53|\n", "|47\n", "47|75x\n" }) {
+        write_file(path, contents);
+        EXPECT_EQ(exchange(server, "reload\n75,47\n"), "error Not a valid rule\ninvalid 75\n");
+    }
+
+    std::remove(path.c_str());
+}
+
+TEST(RuleServer, ClientClosesBeforeReplies)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_closed.txt";
+    write_file(path, "47|75\n\n");
+    RuleServer server { path };
+    ignore_broken_pipe();
+
+    std::array<int, 2> in {};
+    std::array<int, 2> out {};
+    ASSERT_EQ(::pipe(in.data()), 0);
+    ASSERT_EQ(::pipe(out.data()), 0);
+    ASSERT_EQ(::write(in[1], "75,47\n", 6), 6);
+    ::close(in[1]);
+    ::close(out[0]);
+
+    EXPECT_THROW(server.serve(in[0], out[1]), std::system_error);
+    ::close(in[0]);
+    ::close(out[1]);
+
+    // Still answers the next client
+    EXPECT_EQ(exchange(server, "47,75\n"), "valid 75\n");
+
+    std::remove(path.c_str());
+}
+
+TEST(RuleServer, IdleClientDoesNotBlockOthers)
+{
+    const std::string path = ::testing::TempDir() + "rule_server_clients.txt";
+    const std::string socket_path = ::testing::TempDir() + "rule_server_clients.sock";
+    write_file(path, "47|53\n97|13\n97|61\n97|47\n75|29\n61|13\n75|53\n29|13\n97|29\n53|29\n"
+                     "61|53\n97|53\n61|29\n47|13\n75|47\n97|75\n47|61\n75|61\n47|29\n75|13\n"
+                     "53|13\n\n");
+    RuleServer server { path };
+    std::jthread server_thread { [&server, &socket_path](std::stop_token stop) {
+        server.listen(socket_path, stop);
+    } };
+
+    // Connected with half a request, and then quiet
+    const int idle = connect_to(socket_path);
+    ASSERT_TRUE(idle >= 0);
+    ASSERT_EQ(::write(idle, "75,4", 4), 4);
+
+    const int busy = connect_to(socket_path);
+    ASSERT_TRUE(busy >= 0);
+    ASSERT_EQ(::write(busy, "75,47,61,53,29\n", 15), 15);
+    EXPECT_EQ(read_reply(busy), "valid 61\n");
+    ASSERT_EQ(::write(busy, "97,13,75,29,47\n", 15), 15);
+    EXPECT_EQ(read_reply(busy), "invalid 47\n");
+    ::close(busy);
+
+    ASSERT_EQ(::write(idle, "7\n", 2), 2);
+    EXPECT_EQ(read_reply(idle), "valid 47\n");
+
+    // Socket clients may only have the current rule file re-read
+    ASSERT_EQ(::write(idle, "reload /etc/passwd\n", 19), 19);
+    EXPECT_EQ(read_reply(idle), "error Only the current rule file can be reloaded\n");
+    ASSERT_EQ(::write(idle, "reload\n", 7), 7);
+    EXPECT_EQ(read_reply(idle), "reloaded " + path + "\n");
+    ::close(idle);
+
+    struct stat socket_stat {};
+    ASSERT_EQ(::stat(socket_path.c_str(), &socket_stat), 0);
+    EXPECT_EQ(socket_stat.st_mode & 0777U, 0600U);
+
+    server_thread.request_stop();
+    server_thread.join();
+    std::remove(path.c_str());
+}
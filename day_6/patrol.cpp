@@ -0,0 +1,376 @@
+#include "patrol.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+static inline constexpr std::uint8_t encode_direction(char direction)
+{
+    switch (direction) {
+    case '^':
+        return 1 << 0;
+    case '>':
+        return 1 << 1;
+    case 'v':
+        return 1 << 2;
+    default:
+        return 1 << 3;
+    }
+}
+
+static inline constexpr std::uint64_t direction_index(char direction)
+{
+    switch (direction) {
+    case '^':
+        return 0;
+    case '>':
+        return 1;
+    case 'v':
+        return 2;
+    default:
+        return 3;
+    }
+}
+
+static inline constexpr char change_direction(char direction)
+{
+    switch (direction) {
+    case '^':
+        return '>';
+    case '>':
+        return 'v';
+    case 'v':
+        return '<';
+    default:
+        return '^';
+    }
+}
+
+static inline bool been_there(const std::vector<std::vector<std::uint8_t>>& records,
+    std::uint64_t row, std::uint64_t col, char direction)
+{
+    const auto ed = encode_direction(direction);
+    return records[row][col] & ed;
+}
+
+static inline bool has_obtacle(
+    const std::vector<std::string>& map, std::uint64_t row, std::uint64_t col)
+{
+    return map[row][col] == '#';
+}
+
+static constexpr std::uint32_t exit_bit { 1U << 31 };
+
+JumpTable::JumpTable(const std::vector<std::string>& map)
+    : nrows { map.size() }
+    , ncols { map.empty() ? 0 : map[0].size() }
+{
+    if (nrows * ncols >= exit_bit) {
+        throw std::invalid_argument("Map too large");
+    }
+
+    stops.resize(nrows * ncols * 4);
+    for (std::uint64_t row {}; row < nrows; ++row) {
+        build_row(map, row);
+    }
+    for (std::uint64_t col {}; col < ncols; ++col) {
+        build_col(map, col);
+    }
+}
+
+JumpTable::Stop JumpTable::stop(std::uint64_t row, std::uint64_t col, char direction) const
+{
+    const auto entry = stops[(row * ncols + col) * 4 + direction_index(direction)];
+    const auto cell = entry & ~exit_bit;
+    return { cell / ncols, cell % ncols, (entry & exit_bit) != 0 };
+}
+
+void JumpTable::build_row(const std::vector<std::string>& map, std::uint64_t row)
+{
+    const auto entry = [this, row](std::uint64_t col, char direction) -> std::uint32_t& {
+        return stops[(row * ncols + col) * 4 + direction_index(direction)];
+    };
+
+    // Sweep against the walking direction, carrying the stop of the current run
+    auto stop = static_cast<std::uint32_t>(row * ncols) | exit_bit;
+    for (std::uint64_t col {}; col < ncols; ++col) {
+        if (has_obtacle(map, row, col)) {
+            stop = static_cast<std::uint32_t>(row * ncols + col + 1);
+        } else {
+            entry(col, '<') = stop;
+        }
+    }
+
+    stop = static_cast<std::uint32_t>(row * ncols + ncols - 1) | exit_bit;
+    for (std::uint64_t col { ncols }; col-- > 0;) {
+        if (has_obtacle(map, row, col)) {
+            stop = static_cast<std::uint32_t>(row * ncols + col - 1);
+        } else {
+            entry(col, '>') = stop;
+        }
+    }
+}
+
+void JumpTable::build_col(const std::vector<std::string>& map, std::uint64_t col)
+{
+    const auto entry = [this, col](std::uint64_t row, char direction) -> std::uint32_t& {
+        return stops[(row * ncols + col) * 4 + direction_index(direction)];
+    };
+
+    auto stop = static_cast<std::uint32_t>(col) | exit_bit;
+    for (std::uint64_t row {}; row < nrows; ++row) {
+        if (has_obtacle(map, row, col)) {
+            stop = static_cast<std::uint32_t>((row + 1) * ncols + col);
+        } else {
+            entry(row, '^') = stop;
+        }
+    }
+
+    stop = static_cast<std::uint32_t>((nrows - 1) * ncols + col) | exit_bit;
+    for (std::uint64_t row { nrows }; row-- > 0;) {
+        if (has_obtacle(map, row, col)) {
+            stop = static_cast<std::uint32_t>((row - 1) * ncols + col);
+        } else {
+            entry(row, 'v') = stop;
+        }
+    }
+}
+
+TraceResult trace(const std::vector<std::string>& map, const JumpTable& jumps, std::uint64_t row,
+    std::uint64_t col)
+{
+    const auto nrows = map.size();
+    const auto ncols = map[0].size();
+    TraceResult result { false, {}, {} };
+    auto& records = result.records;
+    records.assign(nrows, std::vector<std::uint8_t>(ncols, 0));
+
+    char direction = map[row][col];
+    while (true) {
+        if (been_there(records, row, col, direction)) {
+            result.has_loop = true;
+            return result;
+        }
+
+        const auto stop = jumps.stop(row, col, direction);
+        const auto ed = encode_direction(direction);
+        while (true) {
+            records[row][col] |= ed;
+            result.states.push_back({ row, col, direction });
+            if (row == stop.row && col == stop.col) {
+                break;
+            }
+            row = row + (stop.row > row) - (stop.row < row);
+            col = col + (stop.col > col) - (stop.col < col);
+        }
+
+        if (stop.exits) {
+            return result;
+        }
+        direction = change_direction(direction);
+    }
+}
+
+VisitedStates::VisitedStates()
+    : slots(64, Slot { 0, 0 })
+{
+}
+
+void VisitedStates::clear()
+{
+    size = 0;
+    if (++epoch == 0) {
+        // Wrapped around: slots from 2^32 walks ago would look current
+        std::ranges::fill(slots, Slot { 0, 0 });
+        epoch = 1;
+    }
+}
+
+bool VisitedStates::visit(std::uint64_t row, std::uint64_t col, char direction)
+{
+    // At most half full, so probe sequences stay short
+    if (2 * (size + 1) > slots.size()) {
+        grow();
+    }
+
+    const std::uint64_t key = (row << 33) | (col << 2) | direction_index(direction);
+    const std::size_t mask = slots.size() - 1;
+    for (auto i = static_cast<std::size_t>((key * 0x9e3779b97f4a7c15ULL) >> 32) & mask;;
+         i = (i + 1) & mask) {
+        auto& slot = slots[i];
+        if (slot.epoch != epoch) {
+            slot = { key, epoch };
+            ++size;
+            return false;
+        }
+        if (slot.key == key) {
+            return true;
+        }
+    }
+}
+
+void VisitedStates::grow()
+{
+    auto old = std::exchange(slots, std::vector<Slot>(2 * slots.size(), Slot { 0, 0 }));
+    size = 0;
+    for (const auto& slot : old) {
+        if (slot.epoch == epoch) {
+            const auto key = slot.key;
+            visit(key >> 33, (key >> 2) & 0x7fffffff, "^>v<"[key & 3]);
+        }
+    }
+}
+
+ObstacleOverlay::ObstacleOverlay(const JumpTable& base_, std::uint64_t row, std::uint64_t col)
+    : base { base_ }
+    , obstacle_row { row }
+    , obstacle_col { col }
+{
+}
+
+JumpTable::Stop ObstacleOverlay::stop(std::uint64_t row, std::uint64_t col, char direction) const
+{
+    const auto stop = base.stop(row, col, direction);
+    switch (direction) {
+    case '^':
+        if (col == obstacle_col && obstacle_row < row && obstacle_row >= stop.row) {
+            return { obstacle_row + 1, col, false };
+        }
+        break;
+    case '>':
+        if (row == obstacle_row && obstacle_col > col && obstacle_col <= stop.col) {
+            return { row, obstacle_col - 1, false };
+        }
+        break;
+    case 'v':
+        if (col == obstacle_col && obstacle_row > row && obstacle_row <= stop.row) {
+            return { obstacle_row - 1, col, false };
+        }
+        break;
+    default:
+        if (row == obstacle_row && obstacle_col < col && obstacle_col >= stop.col) {
+            return { row, obstacle_col + 1, false };
+        }
+        break;
+    }
+    return stop;
+}
+
+template <typename Jumps>
+static bool walks_in_loop(const Jumps& jumps, GuardState start, VisitedStates& visited)
+{
+    visited.clear();
+
+    auto [row, col, direction] = start;
+    while (true) {
+        if (visited.visit(row, col, direction)) {
+            return true;
+        }
+
+        const auto stop = jumps.stop(row, col, direction);
+        if (stop.exits) {
+            return false;
+        }
+        row = stop.row;
+        col = stop.col;
+        direction = change_direction(direction);
+    }
+}
+
+bool has_loop(const JumpTable& jumps, GuardState start, VisitedStates& visited)
+{
+    return walks_in_loop(jumps, start, visited);
+}
+
+bool has_loop(const ObstacleOverlay& jumps, GuardState start, VisitedStates& visited)
+{
+    return walks_in_loop(jumps, start, visited);
+}
+
+bool has_loop(const JumpTable& jumps, GuardState start)
+{
+    VisitedStates visited;
+    return has_loop(jumps, start, visited);
+}
+
+std::pair<std::uint64_t, std::uint64_t> find_starting_position(std::span<const std::string> map)
+{
+    const auto nrows = map.size();
+    const auto ncols = map[0].size();
+
+    for (std::uint64_t i {}; i < nrows; ++i) {
+        for (std::uint64_t j = 0; j < ncols; ++j) {
+            const auto ch = map[i][j];
+            if (ch == '^' || ch == '>' || ch == 'v' || ch == '<') {
+                return { i, j };
+            }
+        }
+    }
+
+    throw std::invalid_argument("Startinng position not found");
+}
+
+std::int64_t count_loop_obstacles(const std::vector<std::string>& map, const JumpTable& jumps,
+    const TraceResult& original, std::size_t num_threads)
+{
+    // only put obstacle on an empty block on the original path, otherwise there's no change
+    // in the trace. A cell is tried once, when the guard first gets there.
+    const auto nrows = map.size();
+    const auto ncols = map[0].size();
+    std::vector<std::vector<std::uint8_t>> tried(nrows, std::vector<std::uint8_t>(ncols, 0));
+    std::vector<std::size_t> candidates;
+    for (std::size_t k { 1 }; k < original.states.size(); ++k) {
+        const auto [i, j, direction] = original.states[k];
+        if (!tried[i][j] && map[i][j] == '.') {
+            tried[i][j] = 1;
+            candidates.push_back(k);
+        }
+    }
+
+    // Loop checks differ a lot in length, so threads take small batches of
+    // candidates as they go rather than fixed shares
+    constexpr std::size_t batch_size { 64 };
+    if (num_threads == 0) {
+        num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    }
+    num_threads = std::clamp<std::size_t>(num_threads, 1, candidates.size() / batch_size + 1);
+
+    std::atomic<std::size_t> next_batch { 0 };
+    std::atomic<std::int64_t> result { 0 };
+    const auto work = [&] {
+        VisitedStates visited;
+        std::int64_t loops {};
+        while (true) {
+            const std::size_t begin = next_batch.fetch_add(batch_size);
+            if (begin >= candidates.size()) {
+                break;
+            }
+            const std::size_t end = std::min(begin + batch_size, candidates.size());
+            for (std::size_t c { begin }; c < end; ++c) {
+                const auto k = candidates[c];
+                const auto [i, j, direction] = original.states[k];
+                if (has_loop(ObstacleOverlay { jumps, i, j }, original.states[k - 1], visited)) {
+                    ++loops;
+                }
+            }
+        }
+        result += loops;
+    };
+
+    if (num_threads == 1) {
+        work();
+    } else {
+        std::vector<std::jthread> workers;
+        for (std::size_t t { 0 }; t < num_threads; ++t) {
+            workers.emplace_back(work);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// For every cell and direction, where a guard walking straight from that cell
+// stops: the cell just before the next obstacle, or the last cell before the
+// edge of the map. Entries of obstacle cells are meaningless.
+class JumpTable {
+public:
+    struct Stop {
+        std::uint64_t row;
+        std::uint64_t col;
+        bool exits;
+    };
+
+    explicit JumpTable(const std::vector<std::string>& map);
+
+    Stop stop(std::uint64_t row, std::uint64_t col, char direction) const;
+
+private:
+    void build_row(const std::vector<std::string>& map, std::uint64_t row);
+    void build_col(const std::vector<std::string>& map, std::uint64_t col);
+
+    std::uint64_t nrows;
+    std::uint64_t ncols;
+    // Four entries per cell, one per direction: the stop's cell index, with
+    // the top bit set if the guard leaves the map there
+    std::vector<std::uint32_t> stops;
+};
+
+// The jump table of the map with one more obstacle, answered on top of the
+// unchanged base table. Only walks along the obstacle's row or column can end
+// differently, and they do exactly when the obstacle lies between the start
+// and the base stop; that is a couple of comparisons per query, and placing
+// the obstacle costs nothing.
+class ObstacleOverlay {
+public:
+    ObstacleOverlay(const JumpTable& base, std::uint64_t row, std::uint64_t col);
+
+    JumpTable::Stop stop(std::uint64_t row, std::uint64_t col, char direction) const;
+
+private:
+    const JumpTable& base;
+    std::uint64_t obstacle_row;
+    std::uint64_t obstacle_col;
+};
+
+// The guard on a cell, facing the way it is about to move or turn
+struct GuardState {
+    std::uint64_t row;
+    std::uint64_t col;
+    char direction;
+};
+
+struct TraceResult {
+    bool has_loop;
+    std::vector<std::vector<std::uint8_t>> records;
+    // Every step of the walk in order. A turn adds the cell once more with the
+    // new direction.
+    std::vector<GuardState> states;
+};
+
+// Walks the guard from (row, col) until it leaves the map or loops. records
+// has a bit per direction the guard crossed each cell with. The walk jumps
+// from turn to turn; loops are detected at the turns.
+TraceResult trace(const std::vector<std::string>& map, const JumpTable& jumps, std::uint64_t row,
+    std::uint64_t col);
+
+// The turn states of a walk, in an open-addressing hash set. Its size follows
+// the number of turns rather than the map area, which matters for large sparse
+// maps. Slots carry the epoch they were filled in, so starting a new walk is a
+// counter increment rather than clearing the table.
+class VisitedStates {
+public:
+    VisitedStates();
+
+    void clear();
+
+    // Marks the state and returns whether it was marked already
+    bool visit(std::uint64_t row, std::uint64_t col, char direction);
+
+private:
+    struct Slot {
+        std::uint64_t key;
+        std::uint32_t epoch;
+    };
+
+    void grow();
+
+    std::uint32_t epoch { 1 };
+    std::size_t size { 0 };
+    std::vector<Slot> slots;
+};
+
+// Whether the guard walks in a loop from `start`. Only the turns are visited,
+// so this costs O(number of turns) in time and memory. Clears and reuses
+// `visited`, and keeps no record of the path.
+bool has_loop(const JumpTable& jumps, GuardState start, VisitedStates& visited);
+bool has_loop(const ObstacleOverlay& jumps, GuardState start, VisitedStates& visited);
+bool has_loop(const JumpTable& jumps, GuardState start);
+
+std::pair<std::uint64_t, std::uint64_t> find_starting_position(std::span<const std::string> map);
+
+// Number of positions where a single new obstacle makes the guard loop. The
+// walk up to the obstacle is the same as in `original`, so each check resumes
+// from the step just before the guard first reaches the candidate. Candidates
+// are collected first and checked on `num_threads` threads (0 picks one per
+// hardware thread), sharing the map and jump table read-only; a candidate is
+// only an ObstacleOverlay on the thread that checks it.
+std::int64_t count_loop_obstacles(const std::vector<std::string>& map, const JumpTable& jumps,
+    const TraceResult& original, std::size_t num_threads = 0);
@@ -0,0 +1,76 @@
+#include "patrol.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename F>
+void run(const char* name, F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    const std::int64_t result = f();
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>12}: {}, {:.1f} ms", name, result, elapsed.count());
+}
+
+// A square map with obstacles at the puzzle input's density (about 5%) and
+// the guard facing up in the middle. Reseeds until the guard leaves the map.
+std::vector<std::string> make_map(std::uint64_t size, std::mt19937_64& rng)
+{
+    std::bernoulli_distribution obstacle { 0.05 };
+    while (true) {
+        std::vector<std::string> map(size, std::string(size, '.'));
+        for (auto& row : map) {
+            for (auto& cell : row) {
+                if (obstacle(rng)) {
+                    cell = '#';
+                }
+            }
+        }
+        map[size / 2][size / 2] = '^';
+
+        const JumpTable jumps { map };
+        if (!has_loop(jumps, { size / 2, size / 2, '^' })) {
+            return map;
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::uint64_t size = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 1000;
+
+    std::mt19937_64 rng { 2024 };
+    const auto map = make_map(size, rng);
+    const auto [row, col] = find_starting_position(map);
+    std::println("{} x {} map", size, size);
+
+    const JumpTable jumps { map };
+    const auto original = trace(map, jumps, row, col);
+    run("trace", [&] {
+        std::int64_t visited {};
+        for (const auto& r : trace(map, jumps, row, col).records) {
+            for (const auto cell : r) {
+                visited += cell != 0;
+            }
+        }
+        return visited;
+    });
+    for (const std::size_t num_threads : { 1U, 2U, 4U, 8U }) {
+        const auto name = std::format("obstacles x{}", num_threads);
+        run(name.c_str(), [&] { return count_loop_obstacles(map, jumps, original, num_threads); });
+    }
+
+    return 0;
+}
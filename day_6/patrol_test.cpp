@@ -0,0 +1,227 @@
+#include "patrol.hpp"
+
+#include <gtest/gtest.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace {
+
+const std::vector<std::string> sample {
+    "....#.....",
+    ".........#",
+    "..........",
+    "..#.......",
+    ".......#..",
+    "..........",
+    ".#..^.....",
+    "........#.",
+    "#.........",
+    "......#...",
+};
+
+// Step-by-step walk as the puzzle describes it; returns the visited cells and
+// sets `loops` if the guard walks in a loop
+std::set<std::pair<std::uint64_t, std::uint64_t>> naive_walk(
+    const std::vector<std::string>& map, std::uint64_t row, std::uint64_t col, bool& loops)
+{
+    static constexpr std::int64_t drow[] { -1, 0, 1, 0 };
+    static constexpr std::int64_t dcol[] { 0, 1, 0, -1 };
+    const std::string directions { "^>v<" };
+
+    auto d = directions.find(map[row][col]);
+    auto r = static_cast<std::int64_t>(row);
+    auto c = static_cast<std::int64_t>(col);
+    const auto nrows = static_cast<std::int64_t>(map.size());
+    const auto ncols = static_cast<std::int64_t>(map[0].size());
+
+    std::set<std::pair<std::uint64_t, std::uint64_t>> visited;
+    std::set<std::tuple<std::int64_t, std::int64_t, std::size_t>> states;
+    loops = false;
+    while (true) {
+        visited.insert({ static_cast<std::uint64_t>(r), static_cast<std::uint64_t>(c) });
+        if (!states.insert({ r, c, d }).second) {
+            loops = true;
+            return visited;
+        }
+        const auto nr = r + drow[d];
+        const auto nc = c + dcol[d];
+        if (nr < 0 || nr >= nrows || nc < 0 || nc >= ncols) {
+            return visited;
+        }
+        if (map[static_cast<std::uint64_t>(nr)][static_cast<std::uint64_t>(nc)] == '#') {
+            d = (d + 1) % 4;
+        } else {
+            r = nr;
+            c = nc;
+        }
+    }
+}
+
+std::vector<std::string> random_map(
+    std::mt19937_64& rng, std::uint64_t nrows, std::uint64_t ncols, double density)
+{
+    std::bernoulli_distribution obstacle { density };
+    std::vector<std::string> map(nrows, std::string(ncols, '.'));
+    for (auto& row : map) {
+        for (auto& cell : row) {
+            if (obstacle(rng)) {
+                cell = '#';
+            }
+        }
+    }
+    map[nrows / 2][ncols / 2] = "^>v<"[rng() % 4];
+    return map;
+}
+
+} // namespace
+
+TEST(Patrol, Sample)
+{
+    const auto map = sample;
+    const auto [row, col] = find_starting_position(map);
+    const JumpTable jumps { map };
+
+    const auto original = trace(map, jumps, row, col);
+    EXPECT_FALSE(original.has_loop);
+    std::int64_t visited {};
+    for (const auto& r : original.records) {
+        for (const auto cell : r) {
+            visited += cell != 0;
+        }
+    }
+    EXPECT_EQ(visited, 41);
+    EXPECT_EQ(count_loop_obstacles(map, jumps, original), 6);
+}
+
+TEST(Patrol, JumpsMatchStepByStepWalk)
+{
+    std::mt19937_64 rng { 2024 };
+    for (int n { 0 }; n < 200; ++n) {
+        const double density = 0.02 + 0.01 * static_cast<double>(n % 10);
+        auto map = random_map(rng, 5 + rng() % 40, 5 + rng() % 40, density);
+        const auto [row, col] = find_starting_position(map);
+        const JumpTable jumps { map };
+
+        bool loops {};
+        const auto expected = naive_walk(map, row, col, loops);
+        const auto result = trace(map, jumps, row, col);
+        EXPECT_EQ(result.has_loop, loops);
+        EXPECT_EQ(has_loop(jumps, { row, col, map[row][col] }), loops);
+
+        std::set<std::pair<std::uint64_t, std::uint64_t>> visited;
+        for (std::uint64_t i {}; i < map.size(); ++i) {
+            for (std::uint64_t j {}; j < map[0].size(); ++j) {
+                if (result.records[i][j] != 0) {
+                    visited.insert({ i, j });
+                }
+            }
+        }
+        EXPECT_EQ(visited, expected);
+    }
+}
+
+TEST(Patrol, LoopObstaclesMatchBruteForce)
+{
+    std::mt19937_64 rng { 6 };
+    for (int n { 0 }; n < 30; ++n) {
+        const double density = 0.05 + 0.01 * static_cast<double>(n % 10);
+        auto map = random_map(rng, 10 + rng() % 20, 10 + rng() % 20, density);
+        const auto [row, col] = find_starting_position(map);
+        const JumpTable jumps { map };
+
+        bool loops {};
+        const auto visited = naive_walk(map, row, col, loops);
+        if (loops) {
+            continue;
+        }
+        std::int64_t expected {};
+        for (const auto& [i, j] : visited) {
+            if (map[i][j] == '.') {
+                map[i][j] = '#';
+                bool candidate_loops {};
+                naive_walk(map, row, col, candidate_loops);
+                expected += candidate_loops;
+                map[i][j] = '.';
+            }
+        }
+
+        const auto original = trace(map, jumps, row, col);
+        EXPECT_EQ(count_loop_obstacles(map, jumps, original), expected);
+    }
+}
+
+TEST(Patrol, LoopObstaclesAnyThreadCount)
+{
+    std::mt19937_64 rng { 45 };
+    for (int n { 0 }; n < 10; ++n) {
+        const auto map = random_map(rng, 200, 200, 0.04);
+        const auto [row, col] = find_starting_position(map);
+        const JumpTable jumps { map };
+        const auto original = trace(map, jumps, row, col);
+
+        const auto expected = count_loop_obstacles(map, jumps, original, 1);
+        for (const std::size_t num_threads : { 2U, 3U, 8U }) {
+            EXPECT_EQ(count_loop_obstacles(map, jumps, original, num_threads), expected);
+        }
+    }
+}
+
+TEST(Patrol, VisitedStatesGrowAndClear)
+{
+    VisitedStates visited;
+    EXPECT_FALSE(visited.visit(2, 3, '<'));
+    EXPECT_TRUE(visited.visit(2, 3, '<'));
+    EXPECT_FALSE(visited.visit(2, 3, '^'));
+
+    visited.clear();
+    EXPECT_FALSE(visited.visit(2, 3, '<'));
+    EXPECT_FALSE(visited.visit(2, 3, '^'));
+    EXPECT_TRUE(visited.visit(2, 3, '^'));
+
+    visited.clear();
+    for (std::uint64_t i {}; i < 1000; ++i) {
+        EXPECT_FALSE(visited.visit(i, 1000 - i, "^>v<"[i % 4]));
+    }
+    for (std::uint64_t i {}; i < 1000; ++i) {
+        EXPECT_TRUE(visited.visit(i, 1000 - i, "^>v<"[i % 4]));
+        EXPECT_FALSE(visited.visit(i, 1000 - i, "^>v<"[(i + 1) % 4]));
+    }
+}
+
+TEST(Patrol, OverlayMatchesRebuiltTable)
+{
+    std::mt19937_64 rng { 48 };
+    for (int n { 0 }; n < 50; ++n) {
+        auto map = random_map(rng, 3 + rng() % 15, 3 + rng() % 15, 0.1);
+        const JumpTable base { map };
+        const auto i = rng() % map.size();
+        const auto j = rng() % map[0].size();
+        if (map[i][j] != '.') {
+            continue;
+        }
+        const ObstacleOverlay overlay { base, i, j };
+        map[i][j] = '#';
+        const JumpTable rebuilt { map };
+
+        for (std::uint64_t r {}; r < map.size(); ++r) {
+            for (std::uint64_t c {}; c < map[0].size(); ++c) {
+                if (map[r][c] == '#') {
+                    continue;
+                }
+                for (const char direction : { '^', '>', 'v', '<' }) {
+                    const auto expected = rebuilt.stop(r, c, direction);
+                    const auto stop = overlay.stop(r, c, direction);
+                    EXPECT_EQ(stop.row, expected.row);
+                    EXPECT_EQ(stop.col, expected.col);
+                    EXPECT_EQ(stop.exits, expected.exits);
+                }
+            }
+        }
+    }
+}
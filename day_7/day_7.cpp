@@ -1,102 +1,43 @@
-#include <algorithm>
+#include "equations.hpp"
+
 #include <cstdint>
+#include <cstdlib>
 #include <iostream>
-#include <optional>
 #include <print>
-#include <span>
-#include <sstream>
 #include <string>
-#include <vector>
-
-/// Find x such that a = x || b
-std::optional<int64_t> prefix(std::int64_t a, std::int64_t b)
-{
-    if (a < b) {
-        return std::nullopt;
-    }
-
-    a -= b;
-    do {
-        if (a % 10 != 0) {
-            return std::nullopt;
-        }
-        a /= 10;
-        b /= 10;
-    } while (b);
-
-    return a;
-}
-
-bool is_valid_equation(std::span<const int64_t> operands, int64_t target, bool use_concat)
-{
-    if (operands.empty()) {
-        return false;
-    }
-    const auto operand = operands.front();
-
-    if (operands.size() == 1) {
-        if (operand == target) {
-            std::print("{}", operand);
-            return true;
-        }
-        return false;
-    }
+#include <string_view>
 
-    if (operand <= target && is_valid_equation(operands.subspan(1), target - operand, use_concat)) {
-        std::print(" + {}", operand);
-        return true;
-    }
-
-    if (target % operand == 0
-        && is_valid_equation(operands.subspan(1), target / operand, use_concat)) {
-        std::print(" * {}", operand);
-        return true;
-    }
-
-    if (use_concat) {
-        auto p = prefix(target, operand);
-        if (p.has_value() && is_valid_equation(operands.subspan(1), p.value(), use_concat)) {
-            std::print("||{}", operand);
-            return true;
-        }
-    }
-
-    return false;
-}
-
-std::pair<int64_t, std::vector<int64_t>> parse_line(const std::string& line)
+int main(int argc, char* argv[])
 {
-    std::stringstream ss { line };
-    char colon;
-    int64_t target;
-    int64_t num;
-    std::vector<int64_t> operands;
-    ss >> target >> colon;
-    while (ss >> num) {
-        operands.push_back(num);
+    // With --proof, solved equations are printed with their operators once
+    // the search has finished with them
+    const bool proof = (argc == 2 && std::string_view { argv[1] } == "--proof");
+    if (argc > 2 || (argc == 2 && !proof)) {
+        std::cerr << "Usage: " << argv[0] << " [--proof] < equations" << std::endl;
+        return EXIT_FAILURE;
     }
 
-    return { target, operands };
-}
-
-int main()
-{
     std::string line;
-    std::stringstream ss;
 
     std::int64_t part1_result {};
     std::int64_t part2_result {};
     while (std::getline(std::cin, line)) {
-        auto [target, operands] = parse_line(line);
-        std::reverse(operands.begin(), operands.end());
+        const auto [target, operands] = parse_line(line);
 
+        bool use_concat = false;
         if (is_valid_equation(operands, target, false)) {
             part1_result += target;
             part2_result += target;
-            std::println(" --> {}", target);
         } else if (is_valid_equation(operands, target, true)) {
             part2_result += target;
-            std::println(" --> {}", target);
+            use_concat = true;
+        } else {
+            continue;
+        }
+
+        if (proof) {
+            const auto operators = solve_equation(operands, target, use_concat).value();
+            std::println("{} --> {}", format_equation(operands, operators), target);
         }
     }
 
@@ -0,0 +1,249 @@
+#include "equations.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <format>
+#include <limits>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+std::optional<int64_t> prefix(std::int64_t a, std::int64_t b)
+{
+    if (a < b) {
+        return std::nullopt;
+    }
+
+    a -= b;
+    do {
+        if (a % 10 != 0) {
+            return std::nullopt;
+        }
+        a /= 10;
+        b /= 10;
+    } while (b);
+
+    return a;
+}
+
+namespace {
+
+enum class Search { Valid, Invalid, GaveUp };
+
+/// Backtracking that gives up after visiting `budget` nodes
+Search backtrack_within(
+    std::span<const int64_t> operands, int64_t target, bool use_concat, std::size_t& budget)
+{
+    // Undo the operators from the right: the last operand must have been
+    // added, multiplied or concatenated onto whatever the others gave
+    if (operands.empty()) {
+        return Search::Invalid;
+    }
+    if (budget == 0) {
+        return Search::GaveUp;
+    }
+    --budget;
+    const auto operand = operands.back();
+    if (operands.size() == 1) {
+        return operand == target ? Search::Valid : Search::Invalid;
+    }
+    const auto rest = operands.first(operands.size() - 1);
+
+    if (operand <= target) {
+        if (const auto r = backtrack_within(rest, target - operand, use_concat, budget);
+            r != Search::Invalid) {
+            return r;
+        }
+    }
+
+    if (target % operand == 0) {
+        if (const auto r = backtrack_within(rest, target / operand, use_concat, budget);
+            r != Search::Invalid) {
+            return r;
+        }
+    }
+
+    if (use_concat) {
+        auto p = prefix(target, operand);
+        if (p.has_value()) {
+            return backtrack_within(rest, p.value(), use_concat, budget);
+        }
+    }
+
+    return Search::Invalid;
+}
+
+/// a || b, or nothing if that exceeds limit
+std::optional<int64_t> concat(int64_t a, int64_t b, int64_t limit)
+{
+    int64_t scale { 10 };
+    while (scale <= b) {
+        scale *= 10;
+    }
+    if (a > (limit - b) / scale) {
+        return std::nullopt;
+    }
+    return a * scale + b;
+}
+
+} // namespace
+
+bool backtrack(std::span<const int64_t> operands, int64_t target, bool use_concat)
+{
+    auto budget = std::numeric_limits<std::size_t>::max();
+    return backtrack_within(operands, target, use_concat, budget) == Search::Valid;
+}
+
+bool is_valid_equation(std::span<const int64_t> operands, int64_t target, bool use_concat)
+{
+    if (operands.size() <= meet_in_the_middle_threshold) {
+        return backtrack(operands, target, use_concat);
+    }
+
+    // Backtracking is usually much faster, so it gets a go first. Typical
+    // equations need a few hundred nodes; one that runs out of budget is likely
+    // to be one of the exponential cases.
+    std::size_t budget { backtrack_budget };
+    switch (backtrack_within(operands, target, use_concat, budget)) {
+    case Search::Valid:
+        return true;
+    case Search::Invalid:
+        return false;
+    case Search::GaveUp:
+        break;
+    }
+    return meet_in_the_middle(operands, target, use_concat);
+}
+
+bool meet_in_the_middle(std::span<const int64_t> operands, int64_t target, bool use_concat)
+{
+    if (operands.size() < 2) {
+        return backtrack(operands, target, use_concat);
+    }
+    const auto front = operands.first(operands.size() / 2);
+    const auto back = operands.subspan(front.size());
+
+    // Forward: everything the first half evaluates to, up to the target
+    std::vector<int64_t> values { front.front() };
+    std::vector<int64_t> next;
+    for (const auto operand : front.subspan(1)) {
+        next.clear();
+        for (const auto value : values) {
+            if (value <= target - operand) {
+                next.push_back(value + operand);
+            }
+            if (value <= target / operand) {
+                next.push_back(value * operand);
+            }
+            if (use_concat) {
+                if (const auto c = concat(value, operand, target)) {
+                    next.push_back(*c);
+                }
+            }
+        }
+        // Different operators often land on the same value; keeping one copy
+        // bounds each level by the number of distinct values
+        std::ranges::sort(next);
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        std::swap(values, next);
+    }
+    const std::unordered_set<int64_t> reachable(values.begin(), values.end());
+
+    // Backward: the values the first half would have to produce
+    std::vector<int64_t> targets { target };
+    for (auto it = back.rbegin(); it != back.rend(); ++it) {
+        const auto operand = *it;
+        next.clear();
+        for (const auto t : targets) {
+            if (operand <= t) {
+                next.push_back(t - operand);
+            }
+            if (t % operand == 0) {
+                next.push_back(t / operand);
+            }
+            if (use_concat) {
+                if (const auto p = prefix(t, operand)) {
+                    next.push_back(*p);
+                }
+            }
+        }
+        std::ranges::sort(next);
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        std::swap(targets, next);
+    }
+
+    for (const auto t : targets) {
+        if (reachable.contains(t)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::optional<std::vector<Operator>> solve_equation(
+    std::span<const int64_t> operands, int64_t target, bool use_concat)
+{
+    if (!is_valid_equation(operands, target, use_concat)) {
+        return std::nullopt;
+    }
+
+    // Peel operators off the right, each time keeping the first one that
+    // leaves a solvable rest
+    std::vector<Operator> operators(operands.size() - 1);
+    for (auto rest = operands; rest.size() > 1; rest = rest.first(rest.size() - 1)) {
+        const auto operand = rest.back();
+        const auto head = rest.first(rest.size() - 1);
+        auto& op = operators[head.size() - 1];
+
+        if (operand <= target && is_valid_equation(head, target - operand, use_concat)) {
+            op = Operator::Add;
+            target -= operand;
+        } else if (target % operand == 0 && is_valid_equation(head, target / operand, use_concat)) {
+            op = Operator::Multiply;
+            target /= operand;
+        } else {
+            op = Operator::Concat;
+            target = prefix(target, operand).value();
+        }
+    }
+    return operators;
+}
+
+std::string format_equation(std::span<const int64_t> operands, std::span<const Operator> operators)
+{
+    std::string result = std::format("{}", operands.front());
+    for (std::size_t i { 0 }; i < operators.size(); ++i) {
+        switch (operators[i]) {
+        case Operator::Add:
+            result += std::format(" + {}", operands[i + 1]);
+            break;
+        case Operator::Multiply:
+            result += std::format(" * {}", operands[i + 1]);
+            break;
+        case Operator::Concat:
+            result += std::format("||{}", operands[i + 1]);
+            break;
+        }
+    }
+    return result;
+}
+
+std::pair<int64_t, std::vector<int64_t>> parse_line(const std::string& line)
+{
+    std::stringstream ss { line };
+    char colon;
+    int64_t target;
+    int64_t num;
+    std::vector<int64_t> operands;
+    ss >> target >> colon;
+    while (ss >> num) {
+        operands.push_back(num);
+    }
+
+    return { target, operands };
+}
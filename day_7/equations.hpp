@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+enum class Operator { Add, Multiply, Concat };
+
+/// Find x such that a = x || b
+std::optional<int64_t> prefix(std::int64_t a, std::int64_t b);
+
+/// Whether operators placed between the operands, evaluated left to right,
+/// can give target. Only answers yes or no and prints nothing. Backtracks from
+/// the right; above meet_in_the_middle_threshold operands, backtracking that
+/// visits more than backtrack_budget nodes is abandoned for
+/// meet_in_the_middle().
+bool is_valid_equation(std::span<const int64_t> operands, int64_t target, bool use_concat);
+
+/// is_valid_equation() without the switch, backtracking at any length
+bool backtrack(std::span<const int64_t> operands, int64_t target, bool use_concat);
+
+/// Operand count above which is_valid_equation() may meet in the middle. On
+/// random operands backtracking prunes so well that it stays faster, but
+/// operands like long runs of 1s, which every inverse operator accepts, make it
+/// explore all 3^n sequences; meeting in the middle caps that at about 3^(n/2).
+inline constexpr std::size_t meet_in_the_middle_threshold { 16 };
+inline constexpr std::size_t backtrack_budget { 1 << 16 };
+
+/// is_valid_equation() by splitting the operands in two halves: every value
+/// the first half can evaluate to goes into a hash set, then the operators of
+/// the second half are undone from the target (with prefix() for ||), and the
+/// equation is valid if one of those intermediate targets is in the set. Values
+/// above the target are dropped on both sides, as operands are positive.
+bool meet_in_the_middle(std::span<const int64_t> operands, int64_t target, bool use_concat);
+
+/// One choice of operators for a valid equation, operators[i] going between
+/// operands[i] and operands[i + 1]. Rebuilt with is_valid_equation() one
+/// operator at a time, so it is meant for equations already known to be valid.
+std::optional<std::vector<Operator>> solve_equation(
+    std::span<const int64_t> operands, int64_t target, bool use_concat);
+
+/// Writes a solved equation out, e.g. "81 * 40 + 27" or "15||6"
+std::string format_equation(std::span<const int64_t> operands, std::span<const Operator> operators);
+
+std::pair<int64_t, std::vector<int64_t>> parse_line(const std::string& line);
@@ -0,0 +1,95 @@
+#include "equations.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <print>
+#include <random>
+#include <vector>
+
+namespace {
+
+struct Equation {
+    int64_t target;
+    std::vector<int64_t> operands;
+};
+
+// Equations of `length` operands from 1 to 9 with random operators. Half of
+// them have their target moved off by one, so most of those are unsolvable
+// and the search has to be exhaustive.
+std::vector<Equation> make_digit_equations(
+    std::size_t count, std::size_t length, std::mt19937_64& rng)
+{
+    std::uniform_int_distribution<int64_t> operand { 1, 9 };
+    std::vector<Equation> equations(count);
+    for (std::size_t i { 0 }; i < count; ++i) {
+        auto& [target, operands] = equations[i];
+        operands.resize(length);
+        for (auto& x : operands) {
+            x = operand(rng);
+        }
+        target = operands.front();
+        for (std::size_t k { 1 }; k < length; ++k) {
+            // Mostly additions, so that long equations stay within int64_t
+            if (rng() % 4 == 0) {
+                target *= operands[k];
+            } else {
+                target += operands[k];
+            }
+        }
+        target += static_cast<int64_t>(i % 2);
+    }
+    return equations;
+}
+
+// All operands 1 and an unreachable target: every inverse operator applies at
+// every step, the worst case for backtracking
+std::vector<Equation> make_one_equations(std::size_t count, std::size_t length)
+{
+    return std::vector<Equation>(count, Equation { 1000000007, std::vector<int64_t>(length, 1) });
+}
+
+template <typename F>
+void run(const char* name, const std::vector<Equation>& equations, F f)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t valid { 0 };
+    for (const auto& [target, operands] : equations) {
+        if (f(operands, target)) {
+            ++valid;
+        }
+    }
+    const std::chrono::duration<double, std::milli> elapsed
+        = std::chrono::steady_clock::now() - start;
+    std::println("{:>12}: {}, {:.1f} ms", name, valid, elapsed.count());
+}
+
+void compare(const std::vector<Equation>& equations)
+{
+    run("backtrack", equations,
+        [](const auto& operands, int64_t target) { return backtrack(operands, target, true); });
+    run("middle", equations, [](const auto& operands, int64_t target) {
+        return meet_in_the_middle(operands, target, true);
+    });
+    run("automatic", equations, [](const auto& operands, int64_t target) {
+        return is_valid_equation(operands, target, true);
+    });
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    const std::size_t max_length = (argc > 1) ? std::strtoull(argv[1], nullptr, 10) : 24;
+
+    std::mt19937_64 rng { 2024 };
+    for (std::size_t length { 8 }; length <= max_length; length += 4) {
+        std::println("{} operands from 1 to 9, 100 equations", length);
+        compare(make_digit_equations(100, length, rng));
+        std::println("{} operands of 1, 3 equations", length);
+        compare(make_one_equations(3, length));
+    }
+
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "equations.hpp"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+namespace {
+
+int64_t concat(int64_t a, int64_t b)
+{
+    int64_t scale { 10 };
+    while (scale <= b) {
+        scale *= 10;
+    }
+    return a * scale + b;
+}
+
+int64_t evaluate(std::span<const int64_t> operands, std::span<const Operator> operators)
+{
+    int64_t value = operands.front();
+    for (std::size_t i { 0 }; i < operators.size(); ++i) {
+        switch (operators[i]) {
+        case Operator::Add:
+            value += operands[i + 1];
+            break;
+        case Operator::Multiply:
+            value *= operands[i + 1];
+            break;
+        case Operator::Concat:
+            value = concat(value, operands[i + 1]);
+            break;
+        }
+    }
+    return value;
+}
+
+// Tries every operator sequence
+bool brute_force(std::span<const int64_t> operands, int64_t target, bool use_concat)
+{
+    const std::size_t num_ops = use_concat ? 3 : 2;
+    std::size_t combinations { 1 };
+    for (std::size_t i { 1 }; i < operands.size(); ++i) {
+        combinations *= num_ops;
+    }
+
+    std::vector<Operator> operators(operands.size() - 1);
+    for (std::size_t c { 0 }; c < combinations; ++c) {
+        auto code = c;
+        for (auto& op : operators) {
+            op = static_cast<Operator>(code % num_ops);
+            code /= num_ops;
+        }
+        if (evaluate(operands, operators) == target) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+TEST(Equations, Prefix)
+{
+    EXPECT_EQ(prefix(156, 6), 15);
+    EXPECT_EQ(prefix(12345, 345), 12);
+    EXPECT_EQ(prefix(150, 0), 15);
+    EXPECT_FALSE(prefix(156, 7).has_value());
+    EXPECT_FALSE(prefix(6, 156).has_value());
+}
+
+TEST(Equations, Sample)
+{
+    EXPECT_TRUE(is_valid_equation(std::vector<int64_t> { 81, 40, 27 }, 3267, false));
+    EXPECT_FALSE(is_valid_equation(std::vector<int64_t> { 15, 6 }, 156, false));
+    EXPECT_TRUE(is_valid_equation(std::vector<int64_t> { 15, 6 }, 156, true));
+    EXPECT_FALSE(is_valid_equation(std::vector<int64_t> { 9, 7, 18, 13 }, 21037, true));
+
+    const std::vector<int64_t> operands { 6, 8, 6, 15 };
+    const auto operators = solve_equation(operands, 7290, true);
+    ASSERT_TRUE(operators.has_value());
+    EXPECT_EQ(format_equation(operands, *operators), "6 * 8||6 * 15");
+    EXPECT_FALSE(solve_equation(operands, 7291, true).has_value());
+}
+
+TEST(Equations, MatchesBruteForce)
+{
+    std::mt19937_64 rng { 7 };
+    std::uniform_int_distribution<int64_t> operand { 1, 20 };
+    std::uniform_int_distribution<std::size_t> length { 1, 7 };
+    for (int n { 0 }; n < 2000; ++n) {
+        std::vector<int64_t> operands(length(rng));
+        for (auto& x : operands) {
+            x = operand(rng);
+        }
+        // Half of the targets are reachable by construction
+        const bool use_concat = n % 2 == 0;
+        std::vector<Operator> operators(operands.size() - 1);
+        for (auto& op : operators) {
+            op = static_cast<Operator>(rng() % (use_concat ? 3 : 2));
+        }
+        const int64_t target = evaluate(operands, operators) + (n % 4 < 2 ? 0 : operand(rng));
+
+        const bool expected = brute_force(operands, target, use_concat);
+        EXPECT_EQ(is_valid_equation(operands, target, use_concat), expected);
+        const auto solution = solve_equation(operands, target, use_concat);
+        ASSERT_EQ(solution.has_value(), expected);
+        if (solution) {
+            EXPECT_EQ(evaluate(operands, *solution), target);
+        }
+    }
+}
+
+TEST(Equations, MeetInTheMiddleMatchesBacktracking)
+{
+    std::mt19937_64 rng { 50 };
+    std::uniform_int_distribution<int64_t> operand { 1, 12 };
+    std::uniform_int_distribution<std::size_t> length { 1, 9 };
+    for (int n { 0 }; n < 2000; ++n) {
+        std::vector<int64_t> operands(length(rng));
+        for (auto& x : operands) {
+            x = operand(rng);
+        }
+        const bool use_concat = n % 2 == 0;
+        std::vector<Operator> operators(operands.size() - 1);
+        for (auto& op : operators) {
+            op = static_cast<Operator>(rng() % (use_concat ? 3 : 2));
+        }
+        const int64_t target = evaluate(operands, operators) + (n % 4 < 2 ? 0 : operand(rng));
+
+        EXPECT_EQ(meet_in_the_middle(operands, target, use_concat),
+            backtrack(operands, target, use_concat));
+    }
+}
+
+TEST(Equations, LongEquationsMatchBacktracking)
+{
+    // Past meet_in_the_middle_threshold, so is_valid_equation() may switch over
+    std::mt19937_64 rng { 51 };
+    std::uniform_int_distribution<int64_t> operand { 1, 9 };
+    std::uniform_int_distribution<std::size_t> length { meet_in_the_middle_threshold + 1, 22 };
+    int valid { 0 };
+    for (int n { 0 }; n < 300; ++n) {
+        std::vector<int64_t> operands(length(rng));
+        for (auto& x : operands) {
+            x = operand(rng);
+        }
+        const bool use_concat = n % 2 == 0;
+
+        // Operators that would take the value past 10^12 become +, so nothing overflows
+        int64_t value = operands.front();
+        for (std::size_t i { 1 }; i < operands.size(); ++i) {
+            const std::array<int64_t, 2> step { value, operands[i] };
+            const auto op = static_cast<Operator>(rng() % (use_concat ? 3 : 2));
+            value = evaluate(step, std::array { op });
+            if (value > 1'000'000'000'000) {
+                value = step[0] + step[1];
+            }
+        }
+        const int64_t target = value + (n % 4 < 2 ? 0 : operand(rng));
+
+        const bool expected = backtrack(operands, target, use_concat);
+        valid += expected ? 1 : 0;
+        EXPECT_EQ(is_valid_equation(operands, target, use_concat), expected);
+        EXPECT_EQ(meet_in_the_middle(operands, target, use_concat), expected);
+    }
+    // Both outcomes show up
+    EXPECT_TRUE(valid > 150 && valid < 300);
+}
+
+TEST(Equations, LongRunOfOnes)
+{
+    // 3^40 operator sequences, too many to backtrack through
+    std::vector<int64_t> operands(40, 1);
+    EXPECT_FALSE(is_valid_equation(operands, 1000000007, true));
+    EXPECT_TRUE(is_valid_equation(operands, 40, true));
+    EXPECT_TRUE(is_valid_equation(operands, 1111111111, true));
+}